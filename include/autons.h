@@ -6,4 +6,6 @@ void autonomous();
 void exitAuton();
 
 bool continueAutonStep();
+void runSdCardAuton();
+void runTimedAutonItem();
 void registerAutonTestButtons();
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 #include "vex.h"
 
+// The loop period in milliseconds that the PID gains are tuned for.
+const float PID_TICK_MS = 10;
+
 // A class to represent a PID controller.
 class PID
 {
@@ -25,6 +28,9 @@ private:
   // The error from the previous iteration.
   float previousError = 0;
   
+  // The P, I and D terms of the last update.
+  float pTerm = 0, iTerm = 0, dTerm = 0;
+
   // The time the PID has been settled for.
   float timeSettleTime = 0;
   // The time the PID has been running for.
@@ -35,8 +41,18 @@ public:
   PID(float kp, float kd);
   // A constructor for a full PID controller with P, I, and D terms, as well as exit conditions.
   PID(float kp, float ki, float kd, float starti, float settleError, float settleTime, float timeout);
-  // Computes the PID output.
+  // Computes the PID output, assuming one PID_TICK_MS tick since the last update.
   float update(float error);
+  // Computes the PID output with the measured time since the last update in milliseconds.
+  float update(float error, float dt);
+  // Sets the error of the previous update, so the first D term matches a motion already under way.
+  void setPreviousError(float error);
   // Returns true if the PID has settled or timed out.
   bool isDone();
+  // Returns true if the PID ran longer than its timeout.
+  bool isTimedOut();
+  // Gets the P, I and D terms of the last update, which add up to its output.
+  float getPTerm();
+  float getITerm();
+  float getDTerm();
 };
\ No newline at end of file
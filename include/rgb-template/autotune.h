@@ -0,0 +1,17 @@
+#pragma once
+#include "vex.h"
+
+// The result of Drive::autotuneTurn or Drive::autotuneDrive.
+struct AutotuneResult
+{
+  // True if the relay test oscillated steadily and a candidate met the overshoot limit.
+  bool success;
+  // The ultimate gain in volts per degree or inch and the oscillation period in ms from the relay test.
+  float ultimateGain, ultimatePeriod;
+  // The chosen PID constants, in the same units as setTurnPID and setDrivePID.
+  float kp, ki, kd, starti;
+  // How long the chosen constants took to settle in ms, and how far they overshot.
+  float settleTime, overshoot;
+  // The number of candidates tried and how many met the overshoot limit.
+  int candidates, passed;
+};
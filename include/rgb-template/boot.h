@@ -0,0 +1,82 @@
+#pragma once
+#include "vex.h"
+
+// The state of a boot stage.
+enum BootState
+{
+  BOOT_WAITING = 0,
+  BOOT_RUNNING = 1,
+  BOOT_DONE = 2,
+  BOOT_FAILED = 3,
+  BOOT_SKIPPED = 4     // a stage it depends on failed, so it did not run
+};
+
+class BootPipeline;
+
+// A stage of the boot pipeline.
+struct BootStage
+{
+  const char* name;
+  // Does the work of the stage. Returns false if it failed.
+  bool (*function)();
+  // The stages that must be done before this one starts, as the masks addStage() returned.
+  uint32_t dependencies;
+  volatile BootState state;
+  // When the stage started and ended, in milliseconds from the start of the boot.
+  uint32_t startTime, endTime;
+  // The pipeline, for the stage task.
+  BootPipeline* pipeline;
+};
+
+// Runs the setup of the robot as stages on their own tasks, so the slow ones, like the inertial
+// sensor calibration, overlap the rest instead of holding them up. Each stage starts once the
+// stages it depends on are done; if one of them failed, it is skipped. The pipeline records
+// when each stage started and ended, and prints the boot timeline over serial.
+class BootPipeline
+{
+
+private:
+  // The most stages of a boot.
+  static const int MAX_STAGES = 16;
+
+  BootStage stages[MAX_STAGES];
+  int stageCount = 0;
+
+  // When the boot started, and how long it took until every stage ended, in milliseconds.
+  uint32_t bootStart = 0;
+  uint32_t bootTime = 0;
+  volatile bool started = false;
+
+  // Waits for the dependencies of a stage, then runs it.
+  static int stageTask(void* stage);
+  // Returns true once every stage in the mask has ended.
+  bool hasEnded(uint32_t mask);
+
+public:
+  // Adds a stage that starts once the stages in dependencies are done, and returns its mask:
+  // combine masks with | to make later stages depend on it.
+  uint32_t addStage(const char* name, bool (*function)(), uint32_t dependencies = 0);
+  // Starts every stage. Returns right away; the stages run on their own tasks.
+  void start();
+
+  // Waits until every stage in the mask has ended. Returns true if they all succeeded,
+  // false right away if the boot was not started.
+  bool waitFor(uint32_t mask);
+  // Waits until every stage has ended. Returns true if they all succeeded.
+  bool waitForAll();
+  // Returns true once every stage has ended.
+  bool isFinished();
+
+  // Prints when each stage ran over serial, in the order they started.
+  void report();
+
+  // Gets the number of stages.
+  int getCount();
+  // Gets a stage, with its state and times.
+  BootStage getStage(int index);
+  // Gets how long the boot took until every stage ended, in milliseconds. 0 while it runs.
+  uint32_t getBootTime();
+};
+
+// The boot pipeline pre_auton() runs.
+extern BootPipeline boot;
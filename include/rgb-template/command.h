@@ -0,0 +1,150 @@
+#pragma once
+#include "vex.h"
+
+// Types of the frames sent to the robot.
+enum CommandType
+{
+  COMMAND_DRIVE = 1,        // payload: float distance in inches [, float max voltage]
+  COMMAND_TURN = 2,         // payload: float heading in degrees [, float max voltage]
+  COMMAND_SET_HEADING = 3,  // payload: float heading in degrees
+  COMMAND_STOP = 4,         // no payload; stops the running motion and clears the queue
+  COMMAND_STATUS = 5,       // no payload; asks for a status reply
+  COMMAND_TUNE_DRIVE = 6,   // payload: float distance in inches [, float max voltage]; see TuningSession
+  COMMAND_TUNE_TURN = 7     // payload: float angle in degrees [, float max voltage]
+};
+
+// Types of the frames the robot sends back.
+enum ReplyType
+{
+  REPLY_ACK = 0x81,     // payload: uint8 queue length
+  REPLY_NAK = 0x82,     // payload: uint8 reason, see CommandError
+  REPLY_DONE = 0x83,    // no payload; the command with this sequence number has finished
+  REPLY_STATUS = 0x84,  // payload: float x, y, heading, uint8 running, uint8 queue length
+  REPLY_TUNE = 0x85,    // payload: uint8 move, uint8 MotionExit, float time ms, first in band ms, overshoot
+  STREAM_KEYFRAME = 0x90, // see TelemetryStream
+  STREAM_DELTA = 0x91
+};
+
+// Why a command was refused.
+enum CommandError
+{
+  COMMAND_ERROR_CHECKSUM = 1,
+  COMMAND_ERROR_UNKNOWN = 2,
+  COMMAND_ERROR_QUEUE_FULL = 3
+};
+
+// The start byte of a frame. It never appears in a text command.
+const uint8_t FRAME_START = 0xA5;
+// The largest payload of a frame in bytes.
+const int FRAME_MAX_PAYLOAD = 32;
+
+// Sends a frame on serial port 1. Returns false without sending if the transmit buffer is too full.
+bool sendFrame(uint8_t type, uint8_t sequence, const uint8_t* payload, int length);
+
+// Reads commands from serial port 1 on its own task, so motions and the main loop never wait on it.
+//
+// Two formats are accepted on the same port:
+//   text lines:  "drive 12", "turn 90", "set_heading 0", "stop", "status"
+//                "drive 12 8" and "turn 90 8" set the max voltage, 6 V by default.
+//                "tune turn 90" or "tune drive 24", with an optional max voltage, runs the test move of a
+//                tuning session there and back with the current constants, streams "trace move ms error output"
+//                lines while it runs, then a "result move time firstband overshoot exit" line per move.
+//                "script 2" starts an upload of script2.txt; the script's lines follow, then "end".
+//                The script is checked before it is saved and the reply is "ok script 2 steps 14"
+//                or "error line 3: ...". During an upload "status" is still answered, and "stop" or
+//                "abort" ends the upload; so does no line for 3 seconds. "reload" reads the scripts
+//                on the SD card again.
+//                "set drive_kp 1.6" changes a parameter of the config store right away and "get drive_kp"
+//                reads it; "config" lists them all. "save" writes them to the SD card, "load" reads them back.
+//   frames:      FRAME_START, type, sequence, payload length, payload, checksum
+// The checksum is the low byte of the sum of type, sequence, length and payload. Every frame is
+// answered right away with an ACK or NAK frame carrying the same sequence number. Motion commands
+// go into a bounded queue and run one after another on a second task; a stop command cancels the
+// running motion and clears the queue without waiting.
+class CommandReader
+{
+
+private:
+  // A command waiting in the queue.
+  struct Command
+  {
+    uint8_t type;
+    uint8_t sequence;
+    // True if the command came from a frame and wants frame replies.
+    bool framed;
+    float value;
+    // The max voltage of a motion, or 0 for the default.
+    float maxVoltage;
+  };
+
+  // The number of commands the queue holds.
+  static const int QUEUE_SIZE = 8;
+  // The maximum voltage of the motions, as for the remote control app.
+  static const int MOTION_MAX_VOLTAGE = 6;
+
+  // The drivetrain the commands move.
+  Drive* drive;
+  // Runs the test moves of the tune commands.
+  TuningSession tuner;
+
+  Command queue[QUEUE_SIZE];
+  int queueHead = 0, queueCount = 0;
+  mutex queueLock;
+  // True while the executor runs a command.
+  volatile bool executing = false;
+
+  // The frame being received. frameLength is -1 when no frame is in progress.
+  uint8_t frame[FRAME_MAX_PAYLOAD + 5];
+  int frameLength = -1;
+  // The text line being received.
+  char line[64];
+  int lineLength = 0;
+
+  // The largest script that can be uploaded, in bytes.
+  static const int SCRIPT_SIZE = 4096;
+  // The auton scripts uploads go to. Uploads are refused without them.
+  AutonScripts* scripts = nullptr;
+  // An upload with no line for this long in milliseconds is given up.
+  static const uint32_t SCRIPT_TIMEOUT = 3000;
+  // The script being uploaded, and its number. scriptNumber is 0 when no upload is in progress.
+  char scriptText[SCRIPT_SIZE + 1];
+  int scriptLength = 0;
+  int scriptNumber = 0;
+  // When the last line of the upload arrived.
+  uint32_t scriptLineTime = 0;
+
+  // Handles one received byte.
+  void receive(uint8_t c);
+  // Handles a complete frame or text line.
+  void handleFrame();
+  void handleLine();
+  // Adds a line to the script being uploaded, and saves it at "end".
+  void handleScriptLine();
+  // Ends the upload without saving and says why.
+  void abortScript(const char* reason);
+  // Sets or gets a parameter of the config store.
+  void handleConfigLine(bool set);
+  // Queues a command, or handles stop and status right away.
+  void accept(Command command);
+  // Takes the oldest command off the queue. Returns false if the queue is empty.
+  bool takeCommand(Command& command);
+  // Sends the pose, whether a command is running and the queue length.
+  void sendStatus(Command command);
+  // Runs a tune command and sends the timing of its moves.
+  void runTuning(Command command);
+
+  // The bodies of the reader and executor tasks.
+  static int readerTask(void* reader);
+  static int executorTask(void* reader);
+
+public:
+  // The constructor for the CommandReader class.
+  CommandReader(Drive* drive);
+
+  // Sets the auton scripts that "script" uploads and "reload" go to.
+  void setScripts(AutonScripts* scripts);
+  // Starts the reader and executor tasks.
+  void start();
+  // Gets the number of commands waiting in the queue.
+  int getQueueLength();
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include "vex.h"
+
+// The tuning kept on the SD card. It is plain data, read and written as is, so loading it at
+// boot takes no parsing. Only ever add fields at the end and raise ConfigStore::VERSION: the
+// fields of an older file are still read, and the new fields keep their defaults.
+struct RobotConfig
+{
+  // setMaxVoltage()
+  float turnMaxVoltage, driveMaxVoltage, headingMaxVoltage;
+  // setDrivePID()
+  float driveKp, driveKi, driveKd, driveStarti;
+  // setTurnPID()
+  float turnKp, turnKi, turnKd, turnStarti;
+  // setHeadingPID()
+  float headingKp, headingKd;
+  // setDriveProfile()
+  float maxVelocity, maxAcceleration, maxJerk;
+  // setDriveFeedforward()
+  float kV, kA, kS;
+  // setDriveExitConditions()
+  float driveSettleError, driveSettleTime, driveTimeout;
+  // setTurnExitConditions()
+  float turnSettleError, turnSettleTime, turnTimeout;
+  // setChainExitConditions()
+  float chainDriveError, chainTurnError;
+  // setArcadeConstants()
+  float kBrake, kTurnBias, kTurnDampingFactor;
+  // The drive mode and the auton selected last, remembered across restarts.
+  int32_t driveMode;
+  int32_t autonSelection;
+  // setGainScheduling(): 1 to use the gain schedules, 0 for the PID constants alone. Since version 2.
+  int32_t gainScheduling;
+};
+
+// Keeps the RobotConfig in a binary file on the SD card, so the tuning can change without a
+// recompile and download. The file is written to two slots in turn, config_a.bin and config_b.bin,
+// each with a sequence number and a CRC: load() takes the newest slot that is whole, so losing
+// power in the middle of a save leaves the previous tuning in place.
+// Each parameter has a name, like "drive_kp", to read and change it over serial while the program
+// runs; see CommandReader.
+class ConfigStore
+{
+
+private:
+  // The first bytes of a config file, "RCFG".
+  static const uint32_t MAGIC = 0x47464352;
+  // The version of RobotConfig. Raise it when fields are added.
+  static const uint16_t VERSION = 2;
+
+  RobotConfig config;
+  // The values of setDefaults(), for the values on the SD card that are not allowed.
+  RobotConfig defaults;
+  mutex lock;
+  // The sequence number of the newest slot, and which slot it is: 0 for a, 1 for b, -1 for none.
+  uint32_t sequence = 0;
+  int slot = -1;
+  // Sets the robot up from the config, after a load or a change.
+  void (*apply)() = nullptr;
+
+  // Reads a slot into config. Returns false if it is missing, cut short or from a newer version.
+  bool readSlot(int slot, RobotConfig& config, uint32_t& sequence);
+  // Gets where a parameter is in the config, or nullptr if there is no parameter with the name.
+  void* find(const char* name, bool& integer);
+
+public:
+  // Sets the values used for the parameters that are not on the SD card.
+  void setDefaults(const RobotConfig& defaults);
+  // Sets the function that sets the robot up from the config. It runs after load() and set().
+  void setApply(void (*apply)());
+
+  // Reads the newest whole slot on the SD card over the defaults, then runs the apply function.
+  // Returns false if there was none, which leaves the defaults.
+  bool load();
+  // Writes the config to the older slot. Returns false if there is no SD card or the write failed.
+  bool save();
+
+  // Gets a copy of the config.
+  RobotConfig get();
+  // Returns true if there is a parameter with the name and the value is allowed for it, e.g. a drive
+  // mode that usercontrol() has.
+  bool isAllowed(const char* name, float value);
+  // Sets a parameter by name and runs the apply function. Returns false, changing nothing, if there
+  // is no such parameter or the value is not allowed.
+  bool set(const char* name, float value);
+  // Gets a parameter by name. Returns false if there is no such parameter.
+  bool get(const char* name, float& value);
+  // Prints every parameter over serial, one "name value" per line.
+  void print();
+};
+
+// The tuning of the robot, loaded from the SD card at boot.
+extern ConfigStore configStore;
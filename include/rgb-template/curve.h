@@ -0,0 +1,29 @@
+#pragma once
+#include "vex.h"
+
+// A joystick response curve stored as a lookup table, so the driver loop does not evaluate
+// the curve math on every tick. The table holds the output for each whole input from 0 to
+// 100 and apply() interpolates between entries; negative inputs mirror positive ones.
+class ResponseCurve
+{
+
+private:
+  // The output for the inputs 0, 1, ..., 100.
+  float table[101];
+
+public:
+  // A constructor for a linear curve: the output equals the input.
+  ResponseCurve();
+
+  // The exponential curve of curveFunction(). A larger curveScale gives finer control
+  // near the center of the stick; 0 is linear.
+  static ResponseCurve exponential(float curveScale);
+  // A blend of linear and cubic: (1 - weight) * x + weight * x^3 / 100^2, with weight from 0 to 1.
+  static ResponseCurve cubic(float weight);
+  // Straight lines through count points from (0, 0) to (100, 100), given as inputs and outputs
+  // in percent with the inputs increasing. Lets a driver shape the curve by hand.
+  static ResponseCurve piecewise(const float* inputs, const float* outputs, int count);
+
+  // Gets the output for an input from -100 to 100.
+  float apply(float x) const;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include "vex.h"
+
+// A display manager that owns the controller and brain screens.
+// Callers post text to a line and return right away; a background task writes the lines
+// that changed. Controller writes go over the radio and the controller only takes one about
+// every 50 ms, so the task sends at most one controller write per period: several posts to
+// the same line before then are coalesced into one write of the latest text. Alerts are
+// sent before status text and stay up for a few seconds before status text can replace them.
+class Display
+{
+
+private:
+  // The size of the controller screen, and of the part of the brain screen this class manages.
+  static const int CONTROLLER_ROWS = 3;
+  static const int CONTROLLER_COLUMNS = 24;
+  static const int BRAIN_ROWS = 12;
+  static const int BRAIN_COLUMNS = 48;
+  // The time between controller writes in milliseconds.
+  static const int CONTROLLER_PERIOD = 50;
+  // How long an alert stays on the controller screen in milliseconds.
+  static const int ALERT_HOLD = 3000;
+
+  // A line of the controller screen: the status text and an alert that covers it for a while.
+  struct ControllerLine
+  {
+    char status[CONTROLLER_COLUMNS + 1];
+    char alert[CONTROLLER_COLUMNS + 1];
+    uint32_t alertUntil;
+    // True if the text shown on the controller is out of date.
+    bool dirty;
+  };
+
+  ControllerLine controllerLines[CONTROLLER_ROWS];
+  // The controller line written last, so status lines take turns.
+  int lastControllerRow = 0;
+  // A rumble waiting to be sent, or an empty string.
+  char rumblePattern[8];
+
+  char brainLines[BRAIN_ROWS][BRAIN_COLUMNS + 1];
+  bool brainDirty[BRAIN_ROWS];
+  bool brainClearPending = false;
+  fontType brainFont = mono20;
+  bool brainFontPending = false;
+
+  // Guards the text above while it is copied; never held during a screen write.
+  mutex lock;
+  // True once the display task has started.
+  bool running = false;
+
+  // Sends at most one write to the controller: an alert line, then a rumble, then a status line.
+  void flushController();
+  // Writes the brain lines that changed.
+  void flushBrain();
+  // The body of the display task.
+  static int displayTask(void* display);
+
+public:
+  // The constructor for the Display class.
+  Display();
+
+  // Starts the display task.
+  void start();
+
+  // Shows text on a controller line (1-3).
+  void printController(int row, const char* format, ...);
+  // Shows an alert on the first controller line and rumbles the controller.
+  // Status text posted to the line while the alert is up appears after it.
+  void alert(const char* message, const char* rumblePattern);
+  // Rumbles the controller.
+  void rumble(const char* pattern);
+  // Clears the controller lines, except for alerts that are still up.
+  void clearController();
+
+  // Shows text on a brain screen line (1-12).
+  void printBrain(int row, const char* format, ...);
+  // Clears the brain screen.
+  void clearBrain();
+  // Sets the font of the brain screen for the lines written after it.
+  void setBrainFont(fontType font);
+};
+
+// The display manager for the controller and brain screens.
+extern Display display;
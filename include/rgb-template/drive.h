@@ -1,7 +1,52 @@
 #pragma once
 #include "vex.h"
+#include "rgb-template/PID.h"
+#include "rgb-template/scheduler.h"
+#include "rgb-template/odometry.h"
+#include "rgb-template/heading.h"
+#include "rgb-template/profile.h"
+#include "rgb-template/autotune.h"
+#include "rgb-template/telemetry.h"
+#include "rgb-template/curve.h"
+#include "rgb-template/limiter.h"
+#include "rgb-template/timing.h"
+#include "rgb-template/gains.h"
 #include <string>
 
+class Drive;
+
+// The side of the drivetrain a swing turn pivots on. That side holds still and the other side drives.
+enum SwingSide
+{
+  SWING_LEFT,
+  SWING_RIGHT
+};
+
+// A handle to a motion started by one of the async functions of the Drive class.
+class MotionHandle
+{
+private:
+  // The drivetrain running the motion.
+  Drive* drive;
+  // The id of the motion.
+  int id;
+
+public:
+  // The constructor for the MotionHandle class.
+  MotionHandle(Drive* drive, int id);
+
+  // Returns true until the motion has settled, timed out or been cancelled.
+  bool isRunning();
+  // Waits until the motion has finished.
+  void waitUntilSettled();
+  // Waits until the robot has traveled a distance in inches or the motion has finished.
+  void waitUntilTraveled(float inches);
+  // Waits until the heading error is within a number of degrees or the motion has finished.
+  void waitUntilHeadingWithin(float degrees);
+  // Stops the motion if it is still running.
+  void cancel();
+};
+
 // A class to control the robot's drivetrain.
 class Drive
 {
@@ -16,6 +61,8 @@ private:
   float wheelDiameter;
   // The gear ratio of the drivetrain.
   float gearRatio;
+  // The distance between the left and right wheels in inches.
+  float trackWidth = 12;
 
   // max voltages for driving, turning, and heading correction.
   float driveMaxVoltage, headingMaxVoltage, turnMaxVoltage;
@@ -32,22 +79,137 @@ private:
   // drive exit conditions.
   float driveSettleError = 1, driveSettleTime = 200, driveTimeout = 2000;
 
+  // The gains by motion size for drive and turn motions. While a schedule is empty, its motions
+  // use the constants above.
+  GainSchedule driveSchedule, turnSchedule;
+  // False to use the constants above even with a schedule, e.g. while tuning them.
+  bool gainScheduling = true;
+  // Gets the gains and settle error for a drive in inches or a turn in degrees of a size.
+  GainPoint driveGains(float size);
+  GainPoint turnGains(float size);
+
+  // The pass-through tolerances of chained motions in inches and degrees.
+  float chainDriveError = 3, chainTurnError = 5;
+
   // PID constants for maintaining heading while driving.
   float headingKp, headingKd;
 
+  // Limits for profiled driving in inches and seconds. A jerk of 0 gives a trapezoidal profile.
+  float profileMaxVelocity = 40, profileMaxAcceleration = 80, profileMaxJerk = 400;
+
+  // Feedforward for profiled driving: volts per inch/s, volts per inch/s^2, and volts to overcome friction.
+  float driveKv = 0.18, driveKa = 0.02, driveKs = 0.5;
+
+  // The planned and actual duration of the last profiled drive in milliseconds.
+  float profilePlannedTime = 0, profileActualTime = 0;
+
   // Constants for arcade drive.
   float kBrake = 0.5, kTurnBias = 0.5, kTurnDampingFactor = 0.85;
 
   // allows for a non-proportional steering response
-  float kThrottle = 5, kTurn = 10;
+  ResponseCurve throttleCurve = ResponseCurve::exponential(5), turnCurve = ResponseCurve::exponential(10);
+
+  // Limits the driver control voltages before they reach the motors.
+  OutputLimiter driverLimiter;
+  // The average voltage the driver asked for on the last driver control tick, before limiting.
+  float driverRequested = 0;
+  // Limits and sends the driver control voltages to the two sides of the drivetrain.
+  void driveWithLimitedVoltage(float leftVoltage, float rightVoltage);
 
   // The default brake type for the drivetrain.
   vex::brakeType stopMode = coast;
 
-    // Gets the position of the left side of the drivetrain in inches.
-  float getLeftPosition();
-  // Gets the position of the right side of the drivetrain in inches.
-  float getRightPosition();
+  // The kinds of motion the control task can run, and that can end a chain.
+  enum MotionType { MOTION_DRIVE, MOTION_TURN, MOTION_POINT, MOTION_SWING };
+
+  // True between startChain() and endChain(): motions exit within the pass-through tolerance
+  // and leave the motors running.
+  bool chaining = false;
+  // True when the last motion passed through, so the next one starts from its velocity.
+  bool chainCarry = false;
+  // The last motion that passed through, for endChain() to settle: its type, the distance left,
+  // the heading or the point, the held side of a swing, and its voltages.
+  MotionType chainType;
+  float chainTarget, chainHeading, chainMaxVoltage, chainHeadingMaxVoltage;
+  Point chainPoint;
+  SwingSide chainSide;
+  // The velocity in inches/s and turn rate in degrees/s at the last control tick, and the
+  // position and heading they were measured from.
+  float chainVelocity = 0, chainTurnRate = 0;
+  float velocityPosition = 0, velocityHeading = 0;
+  // Measures the velocity and turn rate over the last control tick.
+  void measureVelocity(float dt, bool first);
+  // Seeds a PID on the first tick of a motion, so a motion after a pass-through picks up the
+  // robot's velocity instead of starting as if from rest. rate is how fast the error shrinks.
+  void carryVelocity(PID& pid, float error, float rate, float dt);
+  // Records a motion that passed through and leaves the motors running.
+  void passThrough(MotionType type, float target, float heading, float maxVoltage, float headingMaxVoltage);
+
+  // The id of the latest motion, incremented each time a motion starts.
+  volatile int motionId = 0;
+  // True while a motion is running.
+  volatile bool motionRunning = false;
+  // Set to stop the running motion.
+  volatile bool motionCancelled = false;
+  // The distance the running motion has traveled in inches.
+  volatile float motionTraveled = 0;
+  // The heading error of the running motion in degrees.
+  volatile float motionHeadingError = 0;
+  // The error and output of the last control tick.
+  volatile float controlError = 0, controlOutput = 0;
+
+  // The parameters of the motion started by an async function.
+  MotionType asyncType;
+  float asyncTarget, asyncMaxVoltage, asyncHeading, asyncHeadingMaxVoltage;
+
+  // Stops any running motion and starts tracking a new one.
+  void beginMotion();
+  // Brakes at the end of a motion: holds at the target, or uses the stop mode if the motion was stopped.
+  void brakeAfterMotion();
+  // Starts a motion on the control task and returns its handle.
+  MotionHandle startAsyncMotion(MotionType type, float target, float maxVoltage, float heading, float headingMaxVoltage);
+  // The body of the control task.
+  static int asyncMotionTask(void* drive);
+
+  // Tracks the pose of the robot.
+  Odometry odometry;
+  // Fuses the inertial sensor and the drive encoders into the heading, on the odometry task.
+  HeadingFilter headingFilter;
+  // Times the odometry task.
+  Scheduler odometryLoop;
+  // True once the odometry task has started.
+  bool odometryRunning = false;
+  // The body of the odometry task, called once per odometry period.
+  static bool odometryTick(float dt, void* drive);
+  static int odometryTask(void* drive);
+
+  // Pushes a telemetry record for the current control tick.
+  void recordTelemetry(TelemetrySource source, float error, PID& pid, float output);
+  // Pushes a telemetry record with the output before limiting and the OutputLimit bits that changed it.
+  void recordTelemetry(TelemetrySource source, float error, PID& pid, float output, float requested, uint8_t limits);
+
+  // Resets the drive encoders to 0.
+  void resetDrivePosition();
+  // Gets how a motion ended, for the motion timer.
+  MotionExit motionExit(PID& pid);
+
+  // The control loops behind turnToHeading and driveDistance.
+  void turnToHeadingLoop(float heading, float turnMaxVoltage);
+  void driveDistanceLoop(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage);
+  // The control loops behind swingToHeading and driveArc.
+  void swingToHeadingLoop(float heading, SwingSide side, float turnMaxVoltage);
+  void driveArcLoop(float radius, float angle, float driveMaxVoltage, float headingMaxVoltage);
+  // The control loop behind driveToPoint and followPath.
+  void followPathLoop(const Point* path, int count, float lookahead, float driveMaxVoltage, float headingMaxVoltage);
+
+  // Switches the drive voltage between +relayVoltage and -relayVoltage around the starting heading or
+  // position until the robot oscillates steadily, and measures the ultimate gain and period.
+  bool relayTest(bool turning, float relayVoltage, float hysteresis, AutotuneResult& result, float& amplitude);
+  // Runs a step of the given size with the current PID constants and measures it. settled is false
+  // if the step timed out or was cancelled.
+  void stepTest(bool turning, float step, float& duration, float& overshoot, bool& settled);
+  // The shared body of autotuneTurn and autotuneDrive.
+  AutotuneResult autotune(bool turning, float maxOvershoot);
 
 
 public: 
@@ -57,14 +219,46 @@ public:
 // The target heading of the robot.
   float targetHeading;
 
+  // Times the control loops of the motions. Its counters report the jitter and overruns of the last motion.
+  Scheduler controlLoop;
+
   // The constructor for the Drive class.
   Drive(motor_group leftDrive, motor_group rightDrive, inertial inertialSensor, float wheelDiameter, float gearRatio);
 
-  // Gets the current heading of the robot.
+  // Gets the position of the left side of the drivetrain in inches.
+  float getLeftPosition();
+  // Gets the position of the right side of the drivetrain in inches.
+  float getRightPosition();
+
+  // Gets the wheel diameter in inches.
+  float getWheelDiameter();
+  // Gets the gear ratio of motor to wheel.
+  float getGearRatio();
+  // Sets the distance between the left and right wheels in inches, used by driveArc and the heading fusion.
+  void setTrackWidth(float trackWidth);
+  // Gets the distance between the left and right wheels in inches.
+  float getTrackWidth();
+
+  // Gets the current heading of the robot. Once odometry has started, this is the heading fused
+  // from the inertial sensor and the drive encoders.
   float getHeading();
+  // Gets the heading of the inertial sensor alone.
+  float getInertialHeading();
+  // Sets the time constant in seconds of the pull of the fused heading toward the inertial sensor,
+  // and how far in degrees the encoders may disagree with it before the wheels count as slipping.
+  void setHeadingFusion(float timeConstant, float slipThreshold);
+  // Returns true while the wheels slip and the heading comes from the inertial sensor alone.
+  bool isWheelSlipping();
   // Sets the current heading of the robot.
   void setHeading(float orientationDeg);
 
+  // Starts the background task that tracks the robot's position on the field.
+  void startOdometry(float periodMs = 5);
+  // Gets the position and heading of the robot on the field.
+  Pose getPose();
+  // Sets the position and heading of the robot on the field, e.g. where the auton routine starts.
+  void setPose(float x, float y, float heading);
+
   // Drives the robot with a specific voltage for each side of the drivetrain.
   void driveWithVoltage(float leftVoltage, float rightVoltage);
 
@@ -80,6 +274,70 @@ public:
   // Drives the robot a specific distance while turning to a heading.
   void driveDistance(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage);
 
+  // Turns the robot to a heading by driving one side and holding the other, pivoting on the held side.
+  void swingToHeading(float heading, SwingSide side);
+  void swingToHeading(float heading, SwingSide side, float turnMaxVoltage);
+  // Drives the center of the robot along an arc of a radius in inches through an angle in degrees.
+  // A positive angle curves clockwise, to the right, and a negative radius drives the arc backward.
+  // Each side drives its own share of the arc while the heading PID keeps the heading on the arc.
+  // A radius of 0 turns in place with turnToHeading, at the turn max voltage or driveMaxVoltage,
+  // whichever is lower; headingMaxVoltage is not used then.
+  void driveArc(float radius, float angle);
+  void driveArc(float radius, float angle, float driveMaxVoltage, float headingMaxVoltage);
+
+  // Drives the robot a specific distance following a motion profile, using feedforward
+  // to track it and the drive PID to correct the error.
+  void driveDistanceProfiled(float distance);
+  // Drives the robot a specific distance following a motion profile with a maximum velocity in inches/s.
+  void driveDistanceProfiled(float distance, float maxVelocity);
+  // Gets the planned duration of the last profiled drive in milliseconds.
+  float getProfilePlannedTime();
+  // Gets how long the last profiled drive actually took in milliseconds, including settling.
+  float getProfileActualTime();
+
+  // Turns the robot to face a point on the field.
+  void turnToPoint(float x, float y);
+  void turnToPoint(float x, float y, float turnMaxVoltage);
+  // Drives the robot to a point on the field, steering toward it on the way.
+  void driveToPoint(float x, float y);
+  void driveToPoint(float x, float y, float driveMaxVoltage, float headingMaxVoltage);
+  // Drives the robot along a path of waypoints without stopping at each one,
+  // steering toward a point lookahead inches ahead on the path.
+  void followPath(const Point* path, int count, float lookahead);
+  void followPath(const Point* path, int count, float lookahead, float driveMaxVoltage, float headingMaxVoltage);
+
+  // The async versions start the motion on a background control task and return right away.
+  MotionHandle turnToHeadingAsync(float heading);
+  MotionHandle turnToHeadingAsync(float heading, float turnMaxVoltage);
+  MotionHandle driveDistanceAsync(float distance);
+  MotionHandle driveDistanceAsync(float distance, float driveMaxVoltage);
+  MotionHandle driveDistanceAsync(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage);
+
+  // Returns true if the motion with this id has not finished yet.
+  bool isMotionRunning(int id);
+  // Returns true while any motion is running.
+  bool isMotionRunning();
+  // Gets the id of the latest motion.
+  int getMotionId();
+  // Gets the distance the current motion has traveled in inches.
+  float getMotionTraveled();
+  // Gets the heading error of the current motion in degrees.
+  float getMotionHeadingError();
+  // Gets the error and output voltage of the last control tick of a motion.
+  float getControlError();
+  float getControlOutput();
+  // Stops the running motion, if any.
+  void cancelMotion();
+
+  // Starts a chain of motions. Until endChain(), each motion exits as soon as it is within the
+  // pass-through tolerance, without settling or holding, and the next one starts from the
+  // robot's velocity, so a route flows instead of stopping at every point.
+  void startChain();
+  // Ends the chain: settles the last motion at its target and holds, like an unchained motion.
+  void endChain();
+  // Sets the pass-through tolerances of chained motions in inches and degrees.
+  void setChainExitConditions(float driveError, float turnError);
+
   // A flag to indicate if the drivetrain needs to be stopped.
   bool drivetrainNeedsStopped = false;
 
@@ -90,21 +348,55 @@ public:
   void controlMecanum(int x, int y, int acc, int steer, motor DriveLF, motor DriveLR, motor DriveRF, motor DriveRB);
 
   void setMaxVoltage(float turnMaxVoltage, float driveMaxVoltage, float headingMaxVoltage);
+  // Sets the period of the motion control loops in milliseconds.
+  void setLoopPeriod(float loopPeriod);
   // Sets the PID constants for driving.
   void setDrivePID(float driveKp, float driveKi, float driveKd, float driveStarti);
   // Sets the exit conditions for driving.
   void setDriveExitConditions(float driveSettleError, float driveSettleTime, float driveTimeout);
+  // Sets the velocity, acceleration and jerk limits for profiled driving.
+  void setDriveProfile(float maxVelocity, float maxAcceleration, float maxJerk);
+  // Sets the feedforward constants for profiled driving.
+  void setDriveFeedforward(float kV, float kA, float kS);
   // Sets the PID constants for maintaining heading.
   void setHeadingPID(float headingKp, float headingKd);
   // Sets the exit conditions for turning.
   void setTurnExitConditions(float turnSettleError, float turnSettleTime, float turnTimeout);
   // Sets the PID constants for turning.
   void setTurnPID(float turnKp, float turnKi, float turnKd, float turnStarti); 
+  // Sets the gain schedules for drives and turns: gains by the size of the motion, interpolated
+  // when a motion starts. They replace the PID constants and settle errors above for their
+  // motions; an empty schedule goes back to them.
+  void setDriveSchedule(const GainSchedule& schedule);
+  void setTurnSchedule(const GainSchedule& schedule);
+  // Turns the gain schedules on or off. Off, every motion uses the PID constants.
+  void setGainScheduling(bool enabled);
+  // Returns true if the gain schedules are on.
+  bool getGainScheduling();
   // Sets the constants for arcade drive.
   void setArcadeConstants(float kBrake, float kTurnBias, float kTurnDampingFactor);
+  // Sets the joystick response curves for throttle and turning in driver control.
+  void setDriverCurves(const ResponseCurve& throttleCurve, const ResponseCurve& turnCurve);
+  // Sets the limits of the driver control voltages: the slew rate in volts per second and the
+  // current budget in amps shared by the drive and the motors added with addCurrentLoad. 0 turns a limit off.
+  void setOutputLimits(float slewRate, float currentBudget);
+  // Adds a motor, like an intake, that draws from the current budget of the drivetrain.
+  void addCurrentLoad(motor& m);
+  // Scales the driver control voltages of a side down from 1 at startTemperature to minScale at
+  // endTemperature in celsius, so hot motors slow down instead of cutting out.
+  void setThermalDerate(float startTemperature, float endTemperature, float minScale);
+
+  // Tunes the turn PID on the robot and applies the result. A relay test finds how the drivetrain
+  // responds, then candidate constants are compared on 90 degree turns and the fastest one
+  // that overshoots by at most maxOvershoot degrees is kept.
+  AutotuneResult autotuneTurn(float maxOvershoot);
+  // Tunes the drive PID the same way using 24 inch drives and maxOvershoot in inches.
+  AutotuneResult autotuneDrive(float maxOvershoot);
 
   // Stops the drivetrain.
   void stop(vex::brakeType mode);
 
   void checkStatus();
+  // Pushes a telemetry record for a driver control iteration.
+  void recordDriverTelemetry();
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include "vex.h"
+
+// The PID gains and settle error for motions of one size.
+struct GainPoint
+{
+  // The size of the motion: inches for drives, degrees for turns.
+  float size;
+  float kp, ki, kd, starti;
+  // The settle error in inches or degrees.
+  float settleError;
+};
+
+// A gain schedule: a table of gains by motion size, so a 3 inch nudge and a 96 inch drive, or
+// a 5 and a 180 degree turn, each get their own gains instead of sharing one compromise.
+// The points are kept sorted by size in a fixed array, and a motion looks its gains up once
+// when it starts, interpolating between the two points around its size, so the control loop
+// itself does no work for it. Sizes outside the table get the gains of the nearest end.
+class GainSchedule
+{
+
+private:
+  // The most points a schedule holds.
+  static const int MAX_POINTS = 8;
+
+  // The points, sorted by size.
+  GainPoint points[MAX_POINTS];
+  int count = 0;
+
+public:
+  // Adds the gains for motions of a size, replacing the point of the same size if there is one.
+  // Returns false if the schedule is full.
+  bool addPoint(float size, float kp, float ki, float kd, float starti, float settleError);
+  // Removes all the points.
+  void clear();
+
+  // Gets the number of points, and a point by its place in size order.
+  int getCount() const;
+  GainPoint getPoint(int i) const;
+
+  // Gets the gains for a motion of a size; the sign of the size is ignored.
+  // Returns false, leaving gains as they were, if the schedule is empty.
+  bool lookup(float size, GainPoint& gains) const;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include "vex.h"
+
+// Estimates the heading from the inertial sensor and the drive encoders together.
+// The encoders give the heading change on every odometry tick, from the difference of the
+// left and right distances over the track width, faster and smoother than the inertial sensor
+// updates. A complementary filter pulls that toward the inertial heading, so the scrub of the
+// wheels in a turn does not add up. The inertial sensor's own drift is measured whenever the
+// encoders show the robot standing still and taken out of its readings, as long as it is slow
+// enough to be drift: a robot turned by hand or by a defender with its wheels still is slipping.
+// When the wheels slip, the encoders stop agreeing with the inertial sensor and the filter
+// uses the inertial sensor alone until they agree again.
+class HeadingFilter
+{
+
+private:
+  // The distance between the left and right wheels in inches.
+  float trackWidth = 12;
+  // The time constant of the pull toward the inertial heading in seconds.
+  float timeConstant = 0.2;
+  // How far in degrees the encoder and inertial headings may drift apart over about 0.1 s
+  // before the wheels count as slipping.
+  float slipThreshold = 3;
+
+  // The fused rotation, and the inertial rotation with its drift taken out, in degrees.
+  // Like inertial::rotation(), they are not wrapped and setHeading() does not change them.
+  volatile float fusedRotation = 0;
+  float inertialRotation = 0;
+  // The heading at rotation 0, set by setHeading().
+  volatile float headingOffset = 0;
+  // The drift of the inertial sensor in degrees per second.
+  float drift = 0;
+  // The recent difference between the encoder and inertial heading changes in degrees.
+  float mismatch = 0;
+  // How long the encoders have shown the robot standing still in milliseconds.
+  float stillTime = 0;
+  // The inertial turn rate while the encoders are still, averaged, in degrees per second.
+  float stillRate = 0;
+  volatile bool slipping = false;
+
+  // The readings of the previous update.
+  float previousLeft = 0, previousRight = 0, previousRotation = 0;
+  // True once the previous readings are valid.
+  bool hasPrevious = false;
+
+public:
+  // Sets the distance between the left and right wheels in inches.
+  void setTrackWidth(float trackWidth);
+  // Sets the time constant of the pull toward the inertial heading in seconds, and the
+  // disagreement in degrees that counts as wheel slip.
+  void setFusion(float timeConstant, float slipThreshold);
+
+  // Advances the estimate with new readings: the left and right drive positions in inches,
+  // the inertial rotation in degrees and the time since the last update in milliseconds.
+  void update(float leftPosition, float rightPosition, float rotation, float dt);
+  // Tells the filter the drive encoders were reset to 0.
+  void resetEncoders();
+  // Sets the current heading in degrees.
+  void setHeading(float heading);
+
+  // Gets the fused heading in degrees, from 0 to 360.
+  float getHeading();
+  // Gets the fused rotation in degrees, like inertial::rotation(): not wrapped and not changed by setHeading().
+  float getRotation();
+  // Gets the measured drift of the inertial sensor in degrees per second.
+  float getDrift();
+  // Returns true while the wheels slip and the filter uses only the inertial sensor.
+  bool isSlipping();
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include "vex.h"
+
+// The most motors a health monitor can watch.
+const int HEALTH_MAX_MOTORS = 12;
+
+// Device faults, one bit each.
+enum HealthFault
+{
+  // The device is not plugged in.
+  FAULT_DISCONNECTED = 1,
+  // The motor is at or above the temperature limit.
+  FAULT_HOT = 2,
+  // The motor is heating up fast enough to reach the temperature limit within the warning time.
+  FAULT_HEATING = 4
+};
+
+// The state of one motor.
+struct MotorHealth
+{
+  const char* name;
+  bool connected;
+  // The temperature in degrees Celsius, the current in amps and the power in watts.
+  float temperature, current, power;
+  // The temperature change over the history in degrees per second.
+  float temperatureSlope;
+  // The seconds until the motor reaches the temperature limit at that slope, or -1 if it is not heating up.
+  float timeToLimit;
+  // The HealthFault bits of the motor.
+  uint8_t faults;
+};
+
+// The state of all watched devices at one time.
+struct HealthSnapshot
+{
+  uint32_t time;
+  int motorCount;
+  MotorHealth motors[HEALTH_MAX_MOTORS];
+  bool inertialConnected;
+  // All fault bits of the devices.
+  uint8_t faults;
+};
+
+// Watches the temperature, current, power and connection of the configured motors and the
+// inertial sensor on a low priority task, a few times a second.
+// Each motor keeps a short history of its temperature, so the monitor can tell how fast it is
+// heating up and warn before it reaches the limit, instead of after it cuts out.
+// When a new fault appears, one alert lists all of the faults at once.
+class HealthMonitor
+{
+
+private:
+  // The number of samples in the history: 30 seconds at the default period.
+  static const int HISTORY_SIZE = 120;
+
+  motor** motors;
+  const char** names;
+  int motorCount;
+  inertial* inertialSensor;
+
+  // Times the health task.
+  Scheduler healthLoop;
+  // True once the health task has started.
+  bool running = false;
+
+  // The temperature limit in degrees Celsius and the warning time in seconds. Keep the limit below
+  // the end of the drive's thermal derate, so the driver is warned before the drive slows down.
+  float temperatureLimit = 50, warningTime = 60;
+
+  // The sample times and the temperature of each motor, as a ring.
+  uint32_t historyTime[HISTORY_SIZE];
+  float history[HEALTH_MAX_MOTORS][HISTORY_SIZE];
+  int historyCount = 0, historyNext = 0;
+
+  // The latest sample, guarded by lock while it is copied.
+  HealthSnapshot snapshot;
+  mutex lock;
+  // The faults already reported, so an alert is only sent when a new one appears.
+  uint8_t reportedFaults[HEALTH_MAX_MOTORS + 1];
+
+  // Reads all devices into a snapshot and adds the temperatures to the history.
+  void sample();
+  // Fits a line to the temperature history of a motor and returns its slope in degrees per second.
+  float temperatureSlope(int motor);
+  // Shows one alert with all current faults; if onlyNew is true, only when there is a new fault.
+  void report(bool onlyNew);
+  // Called once per period by the health task.
+  static bool healthTick(float dt, void* monitor);
+
+public:
+  // A constructor for a monitor of motorCount motors, with a short name for each one for the alerts.
+  HealthMonitor(motor** motors, const char** names, int motorCount, inertial* inertialSensor);
+
+  // Sets the temperature limit in degrees Celsius, and how many seconds before a motor reaches it to warn.
+  void setLimits(float temperatureLimit, float warningTime);
+  // Starts the health task, sampling every periodMs milliseconds.
+  void start(float periodMs = 250);
+  // Samples all devices now and shows an alert with every fault found.
+  // Returns true if there are no faults.
+  bool check();
+  // Gets the latest sample of all devices.
+  HealthSnapshot getSnapshot();
+};
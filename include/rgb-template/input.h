@@ -0,0 +1,108 @@
+#pragma once
+#include "vex.h"
+
+// The buttons of the primary controller.
+enum InputButton
+{
+  BUTTON_L1, BUTTON_L2, BUTTON_R1, BUTTON_R2,
+  BUTTON_UP, BUTTON_DOWN, BUTTON_LEFT, BUTTON_RIGHT,
+  BUTTON_X, BUTTON_B, BUTTON_Y, BUTTON_A,
+  BUTTON_COUNT
+};
+
+// The events a handler can be registered for.
+enum InputEvent
+{
+  // The button went down.
+  INPUT_PRESS,
+  // The button went up.
+  INPUT_RELEASE,
+  // The button has been held for the hold time. Fires once per press.
+  INPUT_HOLD,
+  // The button went down a second time within the double tap time. Fires after INPUT_PRESS.
+  INPUT_DOUBLE_TAP
+};
+
+// A function called for an input event.
+typedef void (*InputHandler)(void);
+
+// One task that samples the controller buttons at a fixed rate and calls the handlers
+// registered for their events, instead of a thread per button that waits on it.
+// Each button must read the same for the debounce time before a change counts.
+// Handlers run on the input task, so they should return quickly; start a thread for
+// anything long, like running an auton.
+class InputDispatcher
+{
+
+private:
+  // The number of handlers that can be registered.
+  static const int MAX_BINDINGS = 32;
+
+  // A handler for an event of one button or a combination of buttons.
+  struct Binding
+  {
+    // A bit for each button that must be down, (1 << InputButton).
+    uint16_t buttons;
+    InputEvent event;
+    InputHandler handler;
+  };
+
+  Binding bindings[MAX_BINDINGS];
+  int bindingCount = 0;
+
+  // Times the input task.
+  Scheduler inputLoop;
+  // True once the input task has started.
+  bool running = false;
+
+  // Timings in milliseconds.
+  float debounceTime = 20, holdTime = 500, doubleTapTime = 300;
+
+  // The debounced state of the buttons, one bit each.
+  uint16_t state = 0;
+  // The buttons whose last press was a double tap, so releasing them does not start another.
+  uint16_t tapUsed = 0;
+  // Button states used instead of the controller's for the buttons in injectMask.
+  volatile uint16_t injected = 0, injectMask = 0;
+  // How long each button's raw state has differed from its debounced state.
+  float changingFor[BUTTON_COUNT];
+  // How long each combination of buttons in bindings has been down; -1 when it is not.
+  float downFor[MAX_BINDINGS];
+  // The time since each button was last released, to detect double taps.
+  float sinceRelease[BUTTON_COUNT];
+
+  // Reads the raw state of all buttons.
+  uint16_t sample();
+  // Debounces a sample and calls the handlers for the events it causes.
+  void update(float dt);
+  // Called once per period by the input task.
+  static bool inputTick(float dt, void* dispatcher);
+
+public:
+  // A constructor for a dispatcher that samples every periodMs milliseconds.
+  InputDispatcher(float periodMs);
+
+  // Calls handler when the button has the event. Handlers are registered before start().
+  void on(InputButton button, InputEvent event, InputHandler handler);
+  // Calls handler when both buttons are down together: INPUT_PRESS when the second one goes
+  // down, INPUT_HOLD when both have been down for the hold time, INPUT_RELEASE when the first
+  // one goes up. The handlers of each button still run too.
+  void onCombo(InputButton first, InputButton second, InputEvent event, InputHandler handler);
+  // Sets the debounce, hold and double tap times in milliseconds.
+  void setTimings(float debounceTime, float holdTime, float doubleTapTime);
+  // Returns true while the button is down, after debouncing.
+  bool isPressed(InputButton button);
+  // Gets the debounced state of all buttons, one bit per InputButton.
+  uint16_t getState();
+  // Uses the given states instead of the controller's for the buttons in mask, one bit per
+  // InputButton, until stopInjecting() is called. Used to play back a recording.
+  void inject(uint16_t buttons, uint16_t mask);
+  // Goes back to reading all buttons from the controller.
+  void stopInjecting();
+
+  // Starts the input task.
+  void start();
+};
+
+// The input dispatcher for the primary controller.
+extern InputDispatcher input;
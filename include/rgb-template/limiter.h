@@ -0,0 +1,66 @@
+#pragma once
+#include "vex.h"
+
+// The limits an OutputLimiter applied on its last call, one bit each.
+enum OutputLimit
+{
+  LIMIT_SLEW = 1,
+  LIMIT_CURRENT = 2,
+  LIMIT_THERMAL = 4
+};
+
+// Shapes the drive voltages of driver control before they reach the motors, so slamming the
+// sticks from full forward to full reverse does not brown out the brain or overheat the motors.
+// Each call applies, in order:
+//   a thermal derate: each side is scaled down smoothly as its motors heat up,
+//   a slew rate: each side's voltage changes by at most so many volts per second,
+//   a current budget: the current the drive motors would draw, estimated from the voltage
+//     above their back EMF, plus the measured current of the other motors sharing the budget,
+//     is kept under a total, by moving the voltages toward the back EMF.
+// Each limit is off until it is set.
+class OutputLimiter
+{
+
+private:
+  // The most motors that can share the current budget with the drive.
+  static const int MAX_SHARED_MOTORS = 4;
+
+  // The slew rate in volts per second, and the current budget in amps. 0 is off.
+  float slewRate = 0, currentBudget = 0;
+  // The current of a V5 motor stalled at 12 volts, in amps.
+  float stallCurrent = 2.5;
+  // The temperatures in celsius where the derate starts and reaches minScale. Equal is off.
+  float derateStart = 0, derateEnd = 0, derateMinScale = 1;
+
+  // Motors outside the drive that draw from the same budget, like an intake.
+  motor* sharedMotors[MAX_SHARED_MOTORS];
+  int sharedCount = 0;
+
+  // The voltages of the last call, and when it was.
+  float leftOutput = 0, rightOutput = 0;
+  uint32_t lastTime = 0;
+  // The thermal scale of each side, changed slowly so a temperature step is not felt as a jolt.
+  float leftScale = 1, rightScale = 1;
+  // The OutputLimit bits of the last call.
+  uint8_t activeLimits = 0;
+
+  // Gets the thermal scale for a temperature.
+  float derateScale(float temperature);
+
+public:
+  // Sets the largest change of each side's voltage in volts per second; 0 turns it off.
+  void setSlewRate(float voltsPerSecond);
+  // Sets the total current the drive and the shared motors may draw in amps; 0 turns it off.
+  void setCurrentBudget(float amps);
+  // Adds a motor that draws from the current budget but is not driven by this limiter.
+  void addSharedMotor(motor& m);
+  // Scales the voltage down linearly from 1 at startTemperature to minScale at endTemperature in celsius.
+  void setThermalDerate(float startTemperature, float endTemperature, float minScale);
+
+  // Limits the voltages requested for the two sides of the drive, in place.
+  void limit(motor_group& leftDrive, motor_group& rightDrive, float& leftVoltage, float& rightVoltage);
+  // Starts the slew from 0 volts, e.g. after the drivetrain has stopped.
+  void reset();
+  // Gets the OutputLimit bits applied on the last call.
+  uint8_t getActiveLimits();
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "vex.h"
+
+// The position of the robot on the field.
+struct Pose
+{
+  // The position in inches.
+  float x;
+  float y;
+  // The heading in degrees, clockwise like the inertial sensor. Heading 0 drives along +y.
+  float heading;
+};
+
+// A point on the field in inches.
+struct Point
+{
+  float x;
+  float y;
+};
+
+// A class to track the pose of the robot from the drive encoders and the inertial sensor.
+class Odometry
+{
+
+private:
+  // The current pose. The heading is kept unwrapped in radians.
+  float x = 0, y = 0, headingRad = 0;
+
+  // The sensor readings from the previous update.
+  float previousLeft = 0, previousRight = 0, previousRotation = 0;
+  // True once the previous readings are valid.
+  bool hasPrevious = false;
+
+  // Incremented before and after each write so readers can detect a torn read.
+  volatile uint32_t sequence = 0;
+
+public:
+  // Advances the pose with new readings: the left and right drive positions in inches and the
+  // inertial rotation in degrees. Assumes the robot drove an arc between the two readings.
+  void update(float leftPosition, float rightPosition, float rotation);
+  // Tells the tracker the drive encoders were reset to 0.
+  void resetEncoders();
+
+  // Gets the current pose. Safe to call from any thread.
+  Pose getPose();
+  // Sets the current pose. Safe to call from any thread.
+  void setPose(Pose pose);
+  // Sets the current heading in degrees, keeping the position.
+  void setHeading(float heading);
+};
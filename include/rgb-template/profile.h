@@ -0,0 +1,44 @@
+#pragma once
+#include "vex.h"
+
+// A class to plan a motion profile: how position, velocity and acceleration should change
+// over time to cover a distance within velocity, acceleration and jerk limits.
+// With a jerk limit the profile is an S-curve, without one it is a trapezoid.
+class MotionProfile
+{
+
+private:
+  // The seven phases are: jerk up, constant acceleration, jerk down, cruise,
+  // then the same three mirrored to slow down.
+  // The duration of each phase in seconds.
+  float phaseTime[7];
+  // The jerk during each phase.
+  float phaseJerk[7];
+  // The acceleration at the start of each phase.
+  float phaseAcceleration[7];
+
+  // The distance to travel, always positive.
+  float distance;
+  // 1 to move forward, -1 to move backward.
+  float direction;
+  // The velocity reached in the cruise phase.
+  float peakVelocity;
+  // The total duration in seconds.
+  float totalTime;
+
+  // Computes the time to reach a velocity from rest within the limits,
+  // and the acceleration and phase times used to get there.
+  static float rampTime(float velocity, float maxAcceleration, float maxJerk, float &acceleration, float &jerkTime, float &accelerationTime);
+
+public:
+  // A constructor for a profile that starts and ends at rest.
+  // Units are inches and seconds. A maxJerk of 0 gives a trapezoidal profile.
+  MotionProfile(float distance, float maxVelocity, float maxAcceleration, float maxJerk);
+
+  // Gets the total duration of the profile in seconds.
+  float getTotalTime();
+  // Gets the highest velocity of the profile.
+  float getPeakVelocity();
+  // Gets the planned position, velocity and acceleration at a time in seconds.
+  void sample(float t, float &position, float &velocity, float &acceleration);
+};
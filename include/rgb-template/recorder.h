@@ -0,0 +1,98 @@
+#pragma once
+#include "vex.h"
+
+// One driver control tick of a recording, as written to the SD card.
+struct RecordedTick
+{
+  // Milliseconds since the recording started.
+  uint32_t time;
+  // The controller axes 1-4 in percent.
+  int8_t axes[4];
+  // The debounced controller buttons, one bit per InputButton.
+  uint16_t buttons;
+  // The pose relative to where the recording started, in tenths: x to the right of the
+  // starting heading and y along it in inches, and the heading change in degrees.
+  int16_t x, y, heading;
+  uint16_t reserved;
+};
+
+// The file format version, written in the file header with the tick size.
+const uint16_t RECORDING_VERSION = 1;
+
+// Records the driver's controller inputs on every driver control tick and plays them back
+// as an autonomous routine through the same controlArcade and controlTank path.
+// Each tick also stores where the robot was, from odometry, since the drive encoders are
+// reset whenever the driver lets go of the sticks. Playback adds a correction toward that
+// recorded pose to the sticks, so a run does not drift with battery level or wheel slip.
+// Recordings are saved as rec1.bin to rec9.bin on the SD card.
+class DriverRecorder
+{
+
+private:
+  // The most ticks in a recording: a minute at the 20 ms driver control period.
+  static const int MAX_TICKS = 3000;
+  // The number of recording files.
+  static const int MAX_RECORDINGS = 9;
+  // The longest time playback keeps correcting toward the last recorded pose, in milliseconds.
+  static const int SETTLE_TIME = 1000;
+
+  // The drivetrain to record and play back.
+  Drive* drive;
+
+  RecordedTick ticks[MAX_TICKS];
+  int tickCount = 0;
+  // The drive mode of the recording, as DRIVE_MODE.
+  uint8_t driveMode = 0;
+  // The time and pose where the recording or the playback started.
+  uint32_t startTime = 0;
+  Pose startPose;
+
+  volatile bool recording = false, playing = false;
+
+  // The numbers of the recordings on the SD card, and their names for the auton menu.
+  int recordingNumbers[MAX_RECORDINGS];
+  char recordingNames[MAX_RECORDINGS][8];
+  int recordingCount = 0;
+
+  // The buttons that are played back; the others keep reading the controller.
+  uint16_t playbackButtons;
+  // The stick correction in percent per inch along the robot's heading and per degree of heading.
+  float kDistance = 12, kHeading = 3;
+
+  // Gets the pose relative to startPose, in inches and degrees.
+  void relativePose(float& x, float& y, float& heading);
+  // Saves the recording to the first unused file. Returns its number, or 0 if it was not saved.
+  int save();
+  // Loads a recording file into ticks. Returns false if it is missing or not a recording.
+  bool load(int number);
+
+public:
+  // The constructor for the DriverRecorder class.
+  DriverRecorder(Drive* drive);
+
+  // Finds the recordings on the SD card and returns how many there are.
+  int scan();
+  // Gets the number of recordings found by scan().
+  int getCount();
+  // Gets the menu name of a recording found by scan().
+  const char* getName(int index);
+
+  // Starts recording the driver control ticks in a drive mode.
+  void startRecording(int driveMode);
+  // Stops recording and saves the recording. Returns its number, or 0 if it was not saved.
+  int stopRecording();
+  // Records one driver control tick. Does nothing unless recording.
+  void recordTick();
+  // Returns true while recording.
+  bool isRecording();
+
+  // Plays a recording found by scan() and returns when it ends.
+  void play(int index);
+  // Returns true while a recording plays; driver control should leave the drivetrain alone.
+  bool isPlaying();
+
+  // Sets the buttons that are played back, one bit per InputButton.
+  void setPlaybackButtons(uint16_t buttons);
+  // Sets the stick correction toward the recorded pose, in percent per inch and percent per degree.
+  void setCorrection(float kDistance, float kHeading);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "vex.h"
+
+// A class to run a control loop at a fixed rate.
+// Each tick sleeps until an absolute deadline instead of waiting a fixed time
+// after the loop body, so sensor reads and motor commands do not stretch the period.
+class Scheduler
+{
+
+private:
+  // The loop period in microseconds.
+  uint32_t period;
+  // The time of the next tick in microseconds.
+  uint64_t deadline = 0;
+  // The time of the previous tick in microseconds.
+  uint64_t previousTick = 0;
+
+  // The number of ticks since start().
+  int tickCount = 0;
+  // The number of ticks that started after their deadline had passed.
+  int overrunCount = 0;
+  // The distance between the last tick and its deadline in milliseconds.
+  float lastJitter = 0;
+  // The largest jitter since start() in milliseconds.
+  float maxJitter = 0;
+  // The sum of the jitter since start() in milliseconds.
+  float totalJitter = 0;
+
+  // The callback and its argument of the task started by startTask().
+  bool (*taskCallback)(float dt, void* arg) = nullptr;
+  void* taskArg = nullptr;
+  // The body of the task started by startTask().
+  static int loopTask(void* scheduler);
+
+public:
+  // A constructor for a scheduler with a period in milliseconds.
+  Scheduler(float periodMs);
+
+  // Sets the loop period in milliseconds.
+  void setPeriod(float periodMs);
+  // Gets the loop period in milliseconds.
+  float getPeriod();
+
+  // Starts timing the loop from now and clears the counters.
+  void start();
+  // Sleeps until the next deadline and returns the measured time since the previous tick in milliseconds.
+  float waitForNextTick();
+  // Calls the callback once per period with the measured dt until it returns false.
+  void run(bool (*callback)(float dt, void* arg), void* arg);
+  // Starts a task with a priority that does run(callback, arg), for the background loops.
+  void startTask(bool (*callback)(float dt, void* arg), void* arg, int32_t priority);
+
+  // Gets the number of ticks since start().
+  int getTickCount();
+  // Gets the number of ticks that overran their deadline since start().
+  int getOverrunCount();
+  // Gets the jitter of the last tick in milliseconds.
+  float getLastJitter();
+  // Gets the largest jitter since start() in milliseconds.
+  float getMaxJitter();
+  // Gets the average jitter since start() in milliseconds.
+  float getAverageJitter();
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include "vex.h"
+
+// The instructions of an auton script.
+enum ScriptOp
+{
+  SCRIPT_DRIVE,     // drive distance [maxVoltage [heading headingMaxVoltage]]
+  SCRIPT_PROFILED,  // profiled distance [maxVelocity]
+  SCRIPT_TURN,      // turn heading [maxVoltage]
+  SCRIPT_FACE,      // face x y [maxVoltage]
+  SCRIPT_GOTO,      // goto x y [maxVoltage headingMaxVoltage]
+  SCRIPT_HEADING,   // heading degrees
+  SCRIPT_POSE,      // pose x y heading
+  SCRIPT_WAIT,      // wait milliseconds
+  SCRIPT_ACTION     // a command added with addAction: name [on | off | number]
+};
+
+// One parsed line of a script.
+struct ScriptInstruction
+{
+  uint8_t op;
+  // The index of the action for SCRIPT_ACTION.
+  uint8_t action;
+  uint8_t argumentCount;
+  // The line of the script it came from, for error messages.
+  uint16_t line;
+  float arguments[4];
+};
+
+// Auton routines written as text files on the SD card, so they can be changed without
+// building and downloading the program. A script has one instruction per line:
+//   name auton_left
+//   pose 0 0 0
+//   intake on
+//   drive 24 6
+//   turn 90
+//   wait 200
+//   intake off
+// "#" starts a comment. The name line is optional and sets the name in the auton menu.
+// Robot-specific commands like "intake" are added with addAction.
+//
+// load() reads script1.txt to script9.txt and parses them into flat arrays of instructions,
+// so nothing is parsed during the match. Each instruction is a step: run() can start at any
+// step and stop after one, which gives step testing without continueAutonStep() calls.
+class AutonScripts
+{
+
+private:
+  static const int MAX_SCRIPTS = 9;
+  static const int MAX_INSTRUCTIONS = 100;
+  static const int MAX_ACTIONS = 16;
+  // The largest script file in bytes.
+  static const int MAX_TEXT = 4096;
+
+  // A command added with addAction.
+  struct Action
+  {
+    const char* name;
+    void (*function)(float value);
+  };
+
+  // The drivetrain the scripts move.
+  Drive* drive;
+
+  Action actions[MAX_ACTIONS];
+  int actionCount = 0;
+
+  ScriptInstruction instructions[MAX_SCRIPTS][MAX_INSTRUCTIONS];
+  int instructionCounts[MAX_SCRIPTS];
+  char names[MAX_SCRIPTS][24];
+  int scriptCount = 0;
+
+  // True while a script runs; load() waits for it to finish instead of changing the instructions.
+  volatile bool running = false;
+
+  // Parses one line. Returns false with a message if it is not a valid instruction.
+  // Sets empty for blank lines, comments and the name line, which give no instruction.
+  bool parseLine(char* text, int lineNumber, ScriptInstruction& instruction, bool& empty, char* name, char* error);
+  // Runs one instruction.
+  void execute(const ScriptInstruction& instruction);
+
+public:
+  // The constructor for the AutonScripts class.
+  AutonScripts(Drive* drive);
+
+  // Adds a command scripts can use, e.g. addAction("intake", setIntake) for "intake on" and
+  // "intake off". The function gets 1 for on, 0 for off, or the number after the name.
+  void addAction(const char* name, void (*function)(float value));
+
+  // Parses a script. Returns the number of instructions, or -1 with a message naming the bad line.
+  int parse(const char* text, ScriptInstruction* out, int maxCount, char* name, char* error);
+  // Reads and parses the scripts on the SD card and returns how many there are. A script with
+  // an error is skipped and the error is shown on the controller.
+  int load();
+  // Checks a script, saves it as scriptN.txt and loads the scripts again. Returns its number of
+  // steps, or -1 with a message if it has an error; the file on the SD card is then left alone.
+  int save(int number, const char* text, char* error);
+
+  // Gets the number of scripts loaded.
+  int getCount();
+  // Gets the name of a script for the auton menu.
+  const char* getName(int index);
+  // Gets the number of steps of a script.
+  int getStepCount(int index);
+
+  // Runs a script from a step to the end, or only that step if singleStep is true.
+  // Returns the step after the last one run.
+  int run(int index, int step, bool singleStep);
+};
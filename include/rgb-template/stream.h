@@ -0,0 +1,56 @@
+#pragma once
+#include "vex.h"
+
+// Streams the robot state over serial port 1 for the RGB_web_simple dashboard, using the
+// frames described in command.h.
+//
+// Values are sent as fixed-point integers: positions, heading and error in tenths, voltages
+// in hundredths. A STREAM_KEYFRAME frame carries them all as int16:
+//   uint16 time ms, uint8 flags (bit 0: a motion is running), uint8 motion id,
+//   int16 x, y, heading, left, right, error, output, battery
+// and the STREAM_DELTA frames after it carry the change since the previous frame as int8:
+//   uint8 ms since the previous frame, uint8 flags, uint8 motion id,
+//   int8 x, y, heading, left, right, error, output, battery
+// A keyframe is sent when a change does not fit in int8 and once a second, so a page that
+// connects late catches up. The frame sequence number counts the samples.
+class TelemetryStream
+{
+
+private:
+  // The number of values in a sample.
+  static const int VALUE_COUNT = 8;
+  // The number of samples between keyframes.
+  static const int KEYFRAME_INTERVAL = 50;
+
+  // The drivetrain to report.
+  Drive* drive;
+  // Times the stream task.
+  Scheduler streamLoop;
+  // True once the stream task has started.
+  bool running = false;
+
+  // The values and time of the last frame sent.
+  int16_t sent[VALUE_COUNT];
+  uint32_t sentTime = 0;
+  // The number of samples since the last keyframe, or -1 to send a keyframe next.
+  int sinceKeyframe = -1;
+  uint8_t sequence = 0;
+  // The number of samples skipped because the serial buffer was full.
+  int skipped = 0;
+
+  // Reads the current state into values.
+  void sample(int16_t* values, uint8_t& flags, uint8_t& motion);
+  // Sends one sample as a keyframe or a delta frame.
+  void send();
+  // Called once per period by the stream task.
+  static bool streamTick(float dt, void* stream);
+
+public:
+  // The constructor for the TelemetryStream class.
+  TelemetryStream(Drive* drive);
+
+  // Starts streaming at a period in milliseconds; 20 ms is 50 Hz.
+  void start(float periodMs = 20);
+  // Gets the number of samples skipped because the serial buffer was full.
+  int getSkipped();
+};
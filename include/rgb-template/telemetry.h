@@ -0,0 +1,104 @@
+#pragma once
+#include "vex.h"
+#include <atomic>
+
+// What produced a telemetry record.
+enum TelemetrySource
+{
+  TELEMETRY_TURN = 1,
+  TELEMETRY_DRIVE = 2,
+  TELEMETRY_PROFILED = 3,
+  TELEMETRY_PATH = 4,
+  TELEMETRY_DRIVER = 5,
+  TELEMETRY_SWING = 6,
+  TELEMETRY_ARC = 7
+};
+
+// One control tick, as written to the SD card. tools/decode_telemetry.py reads the same layout.
+struct TelemetryRecord
+{
+  // Milliseconds since the program started.
+  uint32_t time;
+  // A TelemetrySource.
+  uint8_t source;
+  // The low byte of the motion id, to tell consecutive motions apart.
+  uint8_t motion;
+  // Motor temperatures of the left and right drive in degrees celsius.
+  uint8_t leftTemperature, rightTemperature;
+  // The controller error and its P, I and D terms.
+  float error, p, i, d;
+  // The controller output in volts.
+  float output;
+  // The fused heading in degrees and the drive encoder positions in inches.
+  float heading, leftPosition, rightPosition;
+  // The current of the left and right drive in amps.
+  float leftCurrent, rightCurrent;
+  // The output in volts before the driver control limits, the same as output for motions.
+  float requested;
+  // The OutputLimit bits that changed the output.
+  uint8_t limits;
+  uint8_t reserved[3];
+  // The heading of the inertial sensor alone in degrees; heading is the fused one.
+  float inertialHeading;
+};
+
+// The file format version, written in the file header with the record size. Only add fields at
+// the end of TelemetryRecord, raise the version, and add the new layout to tools/decode_telemetry.py,
+// which keeps the layout of every version so older logs still decode.
+const uint16_t TELEMETRY_VERSION = 3;
+
+// A recorder that the control loops push records into and a low-priority task drains to the SD card.
+// The records sit in a lock-free ring buffer, so pushing never waits on the SD card or a mutex:
+// when the ring is full the record is dropped and counted instead. The flush task is the only
+// consumer. There are two producers, the motion control loops and the driver control loop
+// (recordDriverTelemetry), and push() is only safe between them because VEX tasks are cooperative:
+// a task gives up the brain only when it waits, and push() never waits, so two pushes cannot
+// interleave. On a preemptive scheduler each producer would need its own ring.
+class Telemetry
+{
+
+private:
+  // The number of records the ring holds, a power of two. At a 10 ms loop this is about 10 seconds.
+  static const uint32_t CAPACITY = 1024;
+  // The number of records written to the SD card at once.
+  static const int BATCH_SIZE = 64;
+
+  TelemetryRecord records[CAPACITY];
+  // The number of records pushed and popped since the start. Only push() writes head and only
+  // pop() writes tail.
+  std::atomic<uint32_t> head, tail;
+  // The number of records dropped because the ring was full.
+  std::atomic<uint32_t> dropped;
+
+  // The log file on the SD card.
+  char filename[20];
+  // True once the flush task has started.
+  bool running = false;
+
+  // Writes a batch of records to the SD card.
+  int flush();
+  // The body of the flush task.
+  static int flushTask(void* telemetry);
+
+public:
+  // The constructor for the Telemetry class.
+  Telemetry();
+
+  // Adds a record to the ring. Returns false if the ring was full and the record was dropped.
+  bool push(const TelemetryRecord& record);
+  // Removes up to maxCount of the oldest records into out and returns how many were removed.
+  int pop(TelemetryRecord* out, int maxCount);
+
+  // Starts the flush task writing to the first unused telemetryNN.bin file on the SD card.
+  // Returns false if there is no SD card.
+  bool start();
+  // Gets the name of the log file, or an empty string before start().
+  const char* getFilename();
+  // Gets the number of records waiting in the ring.
+  uint32_t getPending();
+  // Gets the number of records dropped because the ring was full.
+  uint32_t getDropped();
+};
+
+// The telemetry recorder shared by the drivetrain and driver control.
+extern Telemetry telemetry;
@@ -0,0 +1,109 @@
+#pragma once
+#include "vex.h"
+
+// How a motion ended.
+enum MotionExit
+{
+  MOTION_SETTLED = 0,
+  MOTION_TIMED_OUT = 1,
+  MOTION_CANCELLED = 2,
+  MOTION_PASSED = 3     // a chained motion that exited within its pass-through tolerance
+};
+
+// The timing of one motion of an auton run.
+struct MotionTiming
+{
+  // The TelemetrySource of the motion.
+  uint8_t source;
+  // A MotionExit.
+  uint8_t exit;
+  // The auton step the motion ran in.
+  int16_t step;
+  // The distance in inches or the heading in degrees the motion went for.
+  float target;
+  // The whole motion, the time outside and inside the settle band, and the time until the error
+  // first got into the settle band, in milliseconds. firstBandTime is -1 if it never did.
+  float totalTime, movingTime, bandTime, firstBandTime;
+  // How far the motion went past its target, in inches or degrees.
+  float overshoot;
+};
+
+// Times every motion of an auton run, to find where the seconds of a long routine go.
+// The drivetrain motions report each control tick with the error left and the settle band;
+// the auton code marks the run and its steps. At the end of a run the motions and steps are
+// ranked by time on the brain screen and over serial, and written to timingNN.csv on the SD card.
+class MotionTimer
+{
+
+private:
+  // The most motions kept for a run; later ones are only counted in the run time.
+  static const int MAX_MOTIONS = 64;
+  // The most steps in the summary.
+  static const int MAX_STEPS = 32;
+
+  MotionTiming motions[MAX_MOTIONS];
+  int motionCount = 0;
+
+  // The name of the run, its current step, and when it started and ended.
+  char runName[24];
+  int step = 0;
+  uint32_t runStart = 0, runTime = 0;
+
+  // The motion being timed: its settle band, the sign of its first error, and when it started.
+  bool timing = false;
+  float settleError = 0;
+  // How the last motion ended, even past MAX_MOTIONS or outside a run.
+  MotionExit lastExit = MOTION_SETTLED;
+  float startSign = 1;
+  uint32_t motionStart = 0;
+
+public:
+  // The results of a run: its motions, name, step and times, without the motion being timed.
+  struct Run
+  {
+    MotionTiming motions[MAX_MOTIONS];
+    int motionCount;
+    char name[24];
+    int step;
+    uint32_t start, time;
+  };
+
+  // The constructor for the MotionTimer class.
+  MotionTimer();
+
+  // Starts timing a run, clearing the motions of the previous one.
+  void startRun(const char* name, int firstStep);
+  // Sets the auton step the next motions belong to.
+  void setStep(int step);
+  // Ends the run, so the time between and after the motions is counted too.
+  void finishRun();
+  // Copies the results of the run out, and puts them back, e.g. around a tuning session so its
+  // test moves do not wipe the timings of the last auton.
+  void saveRun(Run& run);
+  void restoreRun(const Run& run);
+
+  // Starts timing a motion with the error where it counts as settled.
+  void beginMotion(uint8_t source, float target, float settleError);
+  // Adds a control tick with the error left and its length in milliseconds.
+  void updateMotion(float error, float dt);
+  // Ends the motion.
+  void endMotion(MotionExit exit);
+
+  // Shows the steps and the slowest motions, ranked by time, on the brain screen and prints all
+  // of them over serial.
+  void report();
+  // Writes the motions to the first unused timingNN.csv on the SD card. Returns false if there is no SD card.
+  bool save();
+
+  // Gets the number of motions timed in the run.
+  int getCount();
+  // Gets the timing of a motion of the run.
+  MotionTiming getMotion(int index);
+  // Gets the length of the finished run in milliseconds.
+  float getRunTime();
+  // Gets how the last motion ended.
+  MotionExit getLastExit();
+};
+
+// The motion timer shared by the drivetrain and the auton routines.
+extern MotionTimer motionTimer;
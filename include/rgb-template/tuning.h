@@ -0,0 +1,33 @@
+#pragma once
+#include "vex.h"
+
+// Runs the repeatable test move of a PID tuning session: a turn or a drive there and back.
+// The host changes the constants between runs, e.g. with "set turn_kp 0.25" over serial, and the
+// next run uses them right away, so each try of a constant takes seconds instead of a download.
+// While a move runs, the error and output are sampled and can be printed as a trace; when it ends
+// its time, overshoot and exit come from the motion timer.
+class TuningSession
+{
+
+private:
+  // How often the trace is sampled in milliseconds.
+  static const int SAMPLE_PERIOD = 20;
+
+  // The drivetrain the moves run on.
+  Drive* drive;
+  // The run of the motion timer before the session, put back after it, so tuning after an auton
+  // does not wipe that auton's timings before they are reported or saved.
+  MotionTimer::Run savedRun;
+
+  // Runs one move and waits for it, printing "trace move ms error output" lines if printTrace is set.
+  MotionTiming runMove(int move, bool turning, float target, float maxVoltage, bool printTrace);
+
+public:
+  // The constructor for the TuningSession class.
+  TuningSession(Drive* drive);
+
+  // Turns by distance degrees or drives distance inches, then back to where the robot started,
+  // at maxVoltage, or at the chassis maximum voltage if it is 0. Fills the timing of the two
+  // moves. Returns true if both settled.
+  bool run(bool turning, float distance, float maxVoltage, bool printTrace, MotionTiming results[2]);
+};
@@ -19,10 +19,7 @@ float deadband(float input, float width);
 // A curve function to adjust joystick sensitivity
 double curveFunction(double x, double curveScale);
 
-// Checks if all motors are connected and not overheating.
-bool checkMotors(int motorCount, int temperatureLimit = 50);
-
-// Prints a message to the controller screen with right-padding to 20 characters.
+// Shows a message on the first line of the controller screen, without waiting for the screen.
 void printControllerScreen(const char* message);
 
 
@@ -15,10 +15,25 @@ class Drive;
 // A global instance of the Drive class.
 extern Drive chassis;
 
-extern const int NUMBER_OF_MOTORS;
+// Forward declaration of the DriverRecorder class.
+class DriverRecorder;
+// Records the driver and plays the recordings back as autons.
+extern DriverRecorder recorder;
+// Forward declaration of the AutonScripts class.
+class AutonScripts;
+// The auton scripts on the SD card.
+extern AutonScripts scripts;
+// Forward declaration of the HealthMonitor class.
+class HealthMonitor;
+// The health monitor of the motors and the inertial sensor.
+extern HealthMonitor health;
 extern int DRIVE_MODE;
 
 void setupButtonMapping();
+void registerScriptActions();
 void changeDriveMode();
+void loadDriverCurves();
+void setConfigDefaults();
+void applyConfig();
 void setChassisDefaults();
 void usercontrol();
@@ -23,6 +23,22 @@
 #include "rgb-template/drive.h"
 #include "rgb-template/util.h"
 #include "rgb-template/PID.h"
+#include "rgb-template/scheduler.h"
+#include "rgb-template/odometry.h"
+#include "rgb-template/autotune.h"
+#include "rgb-template/telemetry.h"
+#include "rgb-template/tuning.h"
+#include "rgb-template/command.h"
+#include "rgb-template/stream.h"
+#include "rgb-template/curve.h"
+#include "rgb-template/gains.h"
+#include "rgb-template/display.h"
+#include "rgb-template/input.h"
+#include "rgb-template/health.h"
+#include "rgb-template/recorder.h"
+#include "rgb-template/script.h"
+#include "rgb-template/boot.h"
+#include "rgb-template/config.h"
 
 #define waitUntil(condition)                                                   \
   do {                                                                         \
@@ -30,4 +46,4 @@
   } while (!(condition))
 
 #define repeat(iterations)                                                     \
-  for (int iterator = 0; iterator < iterations; iterator++)
\ No newline at end of file
+  for (int iterator = 0; iterator < iterations; iterator++)
@@ -0,0 +1,73 @@
+// Compares ResponseCurve lookups with curveFunction(), which the driver loop used to call
+// on every tick. Run from the sim folder: make bench
+//
+// The times are for the PC running the benchmark; the V5 brain is much slower at powf, so
+// the difference there is larger.
+
+#include "vex.h"
+#include <chrono>
+#include <stdio.h>
+
+namespace {
+
+const int ROUNDS = 20000;
+
+// Keeps the compiler from optimizing the loops away.
+volatile float sink;
+
+// The inputs the driver loop sees: whole stick values, and stick values scaled by the turn damping factor.
+float inputs[402];
+const int INPUT_COUNT = sizeof(inputs) / sizeof(inputs[0]);
+
+template <typename F>
+double nanosecondsPerCall(F f) {
+  auto start = std::chrono::steady_clock::now();
+  float total = 0;
+  for (int r = 0; r < ROUNDS; r++) {
+    for (int i = 0; i < INPUT_COUNT; i++) {
+      total += f(inputs[i]);
+    }
+  }
+  sink = total;
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / ((double)ROUNDS * INPUT_COUNT);
+}
+
+} // namespace
+
+int main() {
+  for (int i = 0; i <= 200; i++) {
+    inputs[i] = i - 100;
+    inputs[201 + i] = (i - 100) * 0.85;
+  }
+
+  ResponseCurve exponential = ResponseCurve::exponential(10);
+  ResponseCurve cubic = ResponseCurve::cubic(0.6);
+  const float stick[] = {0, 20, 70, 100}, power[] = {0, 10, 50, 100};
+  ResponseCurve piecewise = ResponseCurve::piecewise(stick, power, 4);
+
+  // The table interpolates between whole inputs, so check how far it is from the exact curve.
+  float maxError = 0;
+  for (int i = 0; i < INPUT_COUNT; i++) {
+    maxError = fmax(maxError, fabs(exponential.apply(inputs[i]) - curveFunction(inputs[i], 10)));
+  }
+
+  auto buildStart = std::chrono::steady_clock::now();
+  for (int r = 0; r < 1000; r++) {
+    exponential = ResponseCurve::exponential(10);
+  }
+  std::chrono::duration<double, std::micro> build = std::chrono::steady_clock::now() - buildStart;
+
+  double direct = nanosecondsPerCall([](float x) { return (float)curveFunction(x, 10); });
+  double table = nanosecondsPerCall([&](float x) { return exponential.apply(x); });
+  double cubicTable = nanosecondsPerCall([&](float x) { return cubic.apply(x); });
+  double piecewiseTable = nanosecondsPerCall([&](float x) { return piecewise.apply(x); });
+
+  printf("curveFunction          %6.2f ns/call\n", direct);
+  printf("exponential table      %6.2f ns/call (%.1fx faster)\n", table, direct / table);
+  printf("cubic table            %6.2f ns/call\n", cubicTable);
+  printf("piecewise table        %6.2f ns/call\n", piecewiseTable);
+  printf("table build            %6.2f us, once per setDriverCurves\n", build.count() / 1000);
+  printf("largest difference     %6.4f %% of full power\n", maxError);
+  return 0;
+}
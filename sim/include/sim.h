@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+
+// Host-side simulator controls. Only the simulator runner uses this header;
+// robot code talks to the simulated devices through the normal vex API.
+namespace sim {
+
+// Physical description of the simulated robot.
+struct RobotModel {
+  // Motor ports (0-based, as vex::PORTn) driving the left and right wheels.
+  int leftPorts[8];
+  int leftCount;
+  int rightPorts[8];
+  int rightCount;
+  // Ports of other motors that are plugged in, e.g. an intake.
+  int otherPorts[8];
+  int otherCount;
+  // Port of the inertial sensor.
+  int inertialPort;
+
+  // Wheel diameter in inches.
+  float wheelDiameter;
+  // Gear ratio of motor to wheel, the same value passed to Drive.
+  float gearRatio;
+  // Distance between the left and right wheels in inches.
+  float trackWidth;
+  // Free speed of the drive motor cartridge in rpm.
+  float motorFreeRpm;
+  // Stall torque of one drive motor in Nm.
+  float motorStallTorque;
+  // Stall current of one drive motor in A.
+  float motorStallCurrent;
+  // Robot mass in kg.
+  float mass;
+  // Moment of inertia about the turning center in kg*m^2.
+  float inertia;
+  // Rolling resistance in N per m/s of wheel speed, per side.
+  float viscousFriction;
+  // Dry friction force in N, per side.
+  float coulombFriction;
+  // Inertial sensor drift in degrees per second.
+  float imuDrift;
+};
+
+// Returns the robot model with defaults that match src/robot-config.cpp.
+RobotModel &robot();
+
+// Starts the virtual clock and runs entry() as the first simulated thread.
+// Returns when entry() returns or the virtual time passes limitMs.
+void run(void (*entry)(void), uint32_t limitMs);
+
+// Returns the virtual time in milliseconds.
+double timeMs();
+
+// Ground truth pose of the simulated robot in inches and degrees (heading,
+// clockwise from +y).
+void truePose(float &x, float &y, float &heading);
+// Places the robot and resets its velocity.
+void setTruePose(float x, float y, float heading);
+
+// Sets a controller axis (1-4) to a percentage and a button to pressed or
+// released. Buttons are numbered in the order they appear in vex::controller.
+void setAxis(int axis, int value);
+void setButton(int button, bool pressed);
+
+// Queues bytes to be read from serial channel 1.
+void serialInput(const uint8_t *data, int len);
+// Echo screen writes and serial output to stdout.
+void setVerbose(bool verbose);
+
+// Called each time a drive motor group is stopped with hold, with the
+// virtual time in milliseconds.
+void onHoldStop(void (*callback)(double timeMs));
+
+} // namespace sim
@@ -0,0 +1,29 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       v5.h (host simulator stand-in)                            */
+/*    Description:  The subset of the V5 C API used by this project, backed   */
+/*                  by the host simulator in sim/src/vex_sim.cpp.             */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Reads one byte from a serial channel, or returns -1 if none is waiting.
+int32_t vexSerialReadChar(uint32_t channel);
+// Returns the next byte on a serial channel without consuming it, or -1.
+int32_t vexSerialPeekChar(uint32_t channel);
+// Writes one byte to a serial channel.
+int32_t vexSerialWriteChar(uint32_t channel, uint8_t c);
+// Writes a buffer to a serial channel and returns the number of bytes written.
+int32_t vexSerialWriteBuffer(uint32_t channel, uint8_t *data, uint32_t data_len);
+// Returns the free space in a serial channel's transmit buffer.
+int32_t vexSerialWriteFree(uint32_t channel);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,467 @@
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*    Module:       v5_vcs.h (host simulator stand-in)                        */
+/*    Description:  The subset of the VEX V5 C++ API used by this project.    */
+/*                  Devices, threads and the clock are simulated by           */
+/*                  sim/src/vex_sim.cpp so the robot code can run on a PC.    */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+
+#pragma once
+#include <stdint.h>
+#include <stdarg.h>
+
+namespace vex {
+
+// ---------------------------------------------------------------------------
+//                                  units
+// ---------------------------------------------------------------------------
+
+enum class timeUnits { sec, msec };
+enum class rotationUnits { deg, rev, raw };
+enum class velocityUnits { pct, rpm, dps };
+enum class percentUnits { pct };
+enum class voltageUnits { volt, mV };
+enum class currentUnits { amp };
+enum class powerUnits { watt };
+enum class torqueUnits { Nm, InLb };
+enum class temperatureUnits { celsius, fahrenheit };
+enum class directionType { fwd, rev, undefined };
+enum class brakeType { coast, brake, hold, undefined };
+enum class gearSetting { ratio36_1, ratio18_1, ratio6_1 };
+enum class controllerType { primary, partner };
+enum class axisType { xaxis, yaxis, zaxis };
+enum class fontType { mono12, mono15, mono20, mono30, mono40, mono60, prop20, prop30, prop40, prop60 };
+
+const timeUnits sec = timeUnits::sec;
+const timeUnits seconds = timeUnits::sec;
+const timeUnits msec = timeUnits::msec;
+const rotationUnits deg = rotationUnits::deg;
+const rotationUnits degrees = rotationUnits::deg;
+const rotationUnits rev = rotationUnits::rev;
+const rotationUnits turns = rotationUnits::rev;
+const velocityUnits rpm = velocityUnits::rpm;
+const velocityUnits dps = velocityUnits::dps;
+const percentUnits percent = percentUnits::pct;
+const percentUnits pct = percentUnits::pct;
+const voltageUnits volt = voltageUnits::volt;
+const voltageUnits mV = voltageUnits::mV;
+const currentUnits amp = currentUnits::amp;
+const powerUnits watt = powerUnits::watt;
+const torqueUnits Nm = torqueUnits::Nm;
+const temperatureUnits celsius = temperatureUnits::celsius;
+const temperatureUnits fahrenheit = temperatureUnits::fahrenheit;
+const directionType fwd = directionType::fwd;
+const directionType forward = directionType::fwd;
+const directionType reverse = directionType::rev;
+const brakeType coast = brakeType::coast;
+const brakeType brake = brakeType::brake;
+const brakeType hold = brakeType::hold;
+const gearSetting ratio36_1 = gearSetting::ratio36_1;
+const gearSetting ratio18_1 = gearSetting::ratio18_1;
+const gearSetting ratio6_1 = gearSetting::ratio6_1;
+const controllerType primary = controllerType::primary;
+const controllerType partner = controllerType::partner;
+const axisType xaxis = axisType::xaxis;
+const axisType yaxis = axisType::yaxis;
+const axisType zaxis = axisType::zaxis;
+const fontType mono12 = fontType::mono12;
+const fontType mono15 = fontType::mono15;
+const fontType mono20 = fontType::mono20;
+const fontType mono30 = fontType::mono30;
+const fontType mono40 = fontType::mono40;
+const fontType mono60 = fontType::mono60;
+const fontType prop20 = fontType::prop20;
+const fontType prop30 = fontType::prop30;
+
+enum {
+  PORT1 = 0, PORT2, PORT3, PORT4, PORT5, PORT6, PORT7, PORT8, PORT9, PORT10, PORT11,
+  PORT12, PORT13, PORT14, PORT15, PORT16, PORT17, PORT18, PORT19, PORT20, PORT21
+};
+
+// ---------------------------------------------------------------------------
+//                            threads and timing
+// ---------------------------------------------------------------------------
+
+// Blocks the calling thread for the given time.
+void wait(double time, timeUnits units);
+
+// A cooperatively scheduled thread. Threads only switch when they wait or yield,
+// like on the V5 brain.
+class thread {
+private:
+  int32_t id;
+
+public:
+  thread();
+  thread(int (*callback)(void));
+  thread(void (*callback)(void));
+  thread(int (*callback)(void *), void *arg);
+  thread(void (*callback)(void *), void *arg);
+  ~thread();
+
+  int32_t get_id();
+  void join();
+  void detach();
+  bool joinable();
+  void interrupt();
+  void setPriority(int32_t priority);
+  int32_t priority();
+
+  static void swap(thread &t1, thread &t2);
+  static int32_t hardware_concurrency();
+
+  static const int32_t threadPriorityLow = 1;
+  static const int32_t threadPriorityNormal = 7;
+  static const int32_t threadPriorityHigh = 15;
+};
+
+namespace this_thread {
+  int32_t get_id();
+  void yield();
+  void sleep_for(uint32_t time_ms);
+  void sleep_until(uint32_t time_ms);
+  void set_priority(int32_t priority);
+  int32_t get_priority();
+}
+
+// A task is a thread that can be stopped, suspended and resumed.
+class task {
+private:
+  int32_t id;
+
+public:
+  task();
+  task(int (*callback)(void));
+  task(int (*callback)(void *), void *arg);
+  task(int (*callback)(void), int32_t priority);
+  task(int (*callback)(void *), void *arg, int32_t priority);
+  ~task();
+
+  bool stop();
+  void suspend();
+  void resume();
+  int32_t priority();
+  void setPriority(int32_t priority);
+
+  static void sleep(uint32_t time);
+  static void yield();
+
+  static const int32_t taskPriorityLow = 1;
+  static const int32_t taskPriorityNormal = 7;
+  static const int32_t taskPriorityHigh = 15;
+};
+
+// A mutual exclusion lock for cooperatively scheduled threads.
+class mutex {
+private:
+  volatile int32_t owner;
+
+public:
+  mutex();
+  void lock();
+  bool try_lock();
+  void unlock();
+};
+
+class timer {
+private:
+  uint64_t startTime;
+
+public:
+  timer();
+  // Returns the time since the timer was created or cleared.
+  double time(timeUnits units = timeUnits::msec);
+  double value();
+  void clear();
+  void reset();
+
+  // Returns the system time in milliseconds.
+  static uint32_t system();
+  // Returns the system time in microseconds.
+  static uint64_t systemHighResolution();
+};
+
+// ---------------------------------------------------------------------------
+//                                  devices
+// ---------------------------------------------------------------------------
+
+class color {
+private:
+  uint32_t value;
+
+public:
+  color() : value(0) {}
+  color(uint32_t rgb) : value(rgb) {}
+  uint32_t rgb() const { return value; }
+
+  static const color black;
+  static const color white;
+  static const color red;
+  static const color green;
+  static const color blue;
+  static const color yellow;
+  static const color orange;
+  static const color cyan;
+};
+
+extern const color black;
+extern const color white;
+extern const color red;
+extern const color green;
+extern const color blue;
+extern const color yellow;
+extern const color orange;
+extern const color cyan;
+
+class motor {
+private:
+  int32_t index;
+
+public:
+  motor(int32_t index);
+  motor(int32_t index, bool reverse);
+  motor(int32_t index, gearSetting gears);
+  motor(int32_t index, gearSetting gears, bool reverse);
+
+  int32_t port() const { return index; }
+  int32_t index_() const { return index; }
+
+  bool installed();
+  void setReversed(bool value);
+  void setVelocity(double velocity, velocityUnits units);
+  void setVelocity(double velocity, percentUnits units);
+  void setStopping(brakeType mode);
+  void setMaxTorque(double value, percentUnits units);
+  void setPosition(double value, rotationUnits units);
+  void resetPosition();
+
+  void spin(directionType dir);
+  void spin(directionType dir, double velocity, velocityUnits units);
+  void spin(directionType dir, double velocity, percentUnits units);
+  void spin(directionType dir, double voltage, voltageUnits units);
+  void stop();
+  void stop(brakeType mode);
+
+  bool isSpinning();
+  bool isDone();
+  double position(rotationUnits units);
+  double velocity(velocityUnits units);
+  double velocity(percentUnits units);
+  double current(currentUnits units = currentUnits::amp);
+  double current(percentUnits units);
+  double voltage(voltageUnits units = voltageUnits::volt);
+  double power(powerUnits units = powerUnits::watt);
+  double torque(torqueUnits units = torqueUnits::Nm);
+  double efficiency(percentUnits units = percentUnits::pct);
+  double temperature(temperatureUnits units = temperatureUnits::celsius);
+  double temperature(percentUnits units);
+};
+
+class motor_group {
+private:
+  static const int MAX_MOTORS = 8;
+  int32_t ports[MAX_MOTORS];
+  int32_t motorCount;
+
+  void add(motor &m) {
+    if (motorCount < MAX_MOTORS) ports[motorCount++] = m.port();
+  }
+  void addAll() {}
+  template <typename... Args>
+  void addAll(motor &m, Args &... rest) {
+    add(m);
+    addAll(rest...);
+  }
+
+public:
+  motor_group() : motorCount(0) {}
+  template <typename... Args>
+  motor_group(motor &m1, Args &... rest) : motorCount(0) {
+    addAll(m1, rest...);
+  }
+
+  int32_t count() { return motorCount; }
+
+  void setVelocity(double velocity, velocityUnits units);
+  void setVelocity(double velocity, percentUnits units);
+  void setStopping(brakeType mode);
+  void setPosition(double value, rotationUnits units);
+  void resetPosition();
+
+  void spin(directionType dir);
+  void spin(directionType dir, double velocity, velocityUnits units);
+  void spin(directionType dir, double velocity, percentUnits units);
+  void spin(directionType dir, double voltage, voltageUnits units);
+  void stop();
+  void stop(brakeType mode);
+
+  bool isSpinning();
+  double position(rotationUnits units);
+  double velocity(velocityUnits units);
+  double velocity(percentUnits units);
+  double current(currentUnits units = currentUnits::amp);
+  double current(percentUnits units);
+  double voltage(voltageUnits units = voltageUnits::volt);
+  double power(powerUnits units = powerUnits::watt);
+  double torque(torqueUnits units = torqueUnits::Nm);
+  double efficiency(percentUnits units = percentUnits::pct);
+  double temperature(temperatureUnits units = temperatureUnits::celsius);
+  double temperature(percentUnits units);
+};
+
+class inertial {
+private:
+  int32_t index;
+
+public:
+  inertial(int32_t index);
+
+  bool installed();
+  void calibrate(int32_t value = 0);
+  void startCalibration(int32_t value = 0);
+  bool isCalibrating();
+  void resetHeading();
+  void resetRotation();
+  void setHeading(double value, rotationUnits units);
+  void setRotation(double value, rotationUnits units);
+  double heading(rotationUnits units = rotationUnits::deg);
+  double rotation(rotationUnits units = rotationUnits::deg);
+  double angle(rotationUnits units = rotationUnits::deg);
+  double gyroRate(axisType axis, velocityUnits units);
+  double acceleration(axisType axis);
+};
+
+class controller {
+private:
+  controllerType type;
+
+public:
+  class axis {
+  private:
+    int32_t id;
+
+  public:
+    axis(int32_t id) : id(id) {}
+    int32_t value();
+    int32_t position(percentUnits units = percentUnits::pct);
+  };
+
+  class button {
+  private:
+    int32_t id;
+
+  public:
+    button(int32_t id) : id(id) {}
+    bool pressing();
+    void pressed(void (*callback)(void));
+    void released(void (*callback)(void));
+  };
+
+  class lcd {
+  public:
+    void setCursor(int32_t row, int32_t col);
+    int32_t column();
+    int32_t row();
+    void print(const char *format, ...);
+    void print(int32_t value);
+    void print(double value);
+    void clearScreen();
+    void clearLine(int32_t number);
+    void clearLine();
+    void newLine();
+  };
+
+  controller();
+  controller(controllerType id);
+
+  void rumble(const char *pattern);
+  bool installed();
+
+  axis Axis1;
+  axis Axis2;
+  axis Axis3;
+  axis Axis4;
+  button ButtonL1;
+  button ButtonL2;
+  button ButtonR1;
+  button ButtonR2;
+  button ButtonUp;
+  button ButtonDown;
+  button ButtonLeft;
+  button ButtonRight;
+  button ButtonX;
+  button ButtonB;
+  button ButtonY;
+  button ButtonA;
+  lcd Screen;
+};
+
+class brain {
+public:
+  class lcd {
+  public:
+    void setFont(fontType font);
+    void setPenColor(const color &c);
+    void setFillColor(const color &c);
+    void setPenWidth(uint32_t width);
+    void setCursor(int32_t row, int32_t col);
+    int32_t column();
+    int32_t row();
+    void print(const char *format, ...);
+    void print(int32_t value);
+    void print(double value);
+    void printAt(int32_t x, int32_t y, const char *format, ...);
+    void clearScreen();
+    void clearScreen(const color &c);
+    void clearLine(int32_t number);
+    void clearLine();
+    void newLine();
+    void drawPixel(int32_t x, int32_t y);
+    void drawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+    void drawRectangle(int32_t x, int32_t y, int32_t width, int32_t height);
+    void drawRectangle(int32_t x, int32_t y, int32_t width, int32_t height, const color &c);
+    void drawCircle(int32_t x, int32_t y, int32_t radius);
+    bool pressing();
+    int32_t xPosition();
+    int32_t yPosition();
+    bool render();
+  };
+
+  class battery {
+  public:
+    uint32_t capacity(percentUnits units = percentUnits::pct);
+    double temperature(percentUnits units = percentUnits::pct);
+    double voltage(voltageUnits units = voltageUnits::volt);
+    double current(currentUnits units = currentUnits::amp);
+  };
+
+  class sdcard {
+  public:
+    bool isInserted();
+    int32_t size(const char *name);
+    bool exists(const char *name);
+    int32_t loadfile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t savefile(const char *name, uint8_t *buffer, int32_t len);
+    int32_t appendfile(const char *name, uint8_t *buffer, int32_t len);
+  };
+
+  lcd Screen;
+  timer Timer;
+  battery Battery;
+  sdcard SDcard;
+};
+
+class competition {
+public:
+  competition();
+  void autonomous(void (*callback)(void));
+  void drivercontrol(void (*callback)(void));
+  bool isEnabled();
+  bool isDriverControl();
+  bool isAutonomous();
+  bool isCompetitionSwitch();
+  bool isFieldControl();
+};
+
+} // namespace vex
@@ -0,0 +1,96 @@
+// Runs the autonomous routines from src/autons.cpp in the host simulator and
+// reports how long each motion and each routine took on the virtual clock.
+//
+// Usage: sim [auton number] [-v]
+//   auton number  run only this entry of autonMenuText (default: all)
+//   -v            echo controller and brain screen writes
+
+#include "vex.h"
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern int currentAutonSelection;
+extern int autonNum;
+extern char const * autonMenuText[];
+
+namespace {
+
+const int MAX_MOTIONS = 256;
+// Virtual time limit for one routine, longer than a skills run.
+const uint32_t ROUTINE_LIMIT_MS = 120000;
+
+double motionEnds[MAX_MOTIONS];
+int motionCount = 0;
+
+void recordMotionEnd(double timeMs) {
+  if (motionCount < MAX_MOTIONS) motionEnds[motionCount++] = timeMs;
+}
+
+// The routine currently being simulated.
+int selection = 0;
+double routineStart = 0;
+double routineEnd = 0;
+
+void runRoutine() {
+  // What pre_auton() does, without the menus and the inertial calibration wait.
+  display.start();
+  health.start();
+  setChassisDefaults();
+  chassis.startOdometry();
+  telemetry.start();
+  chassis.setPose(0, 0, 0);
+
+  motionCount = 0;
+  currentAutonSelection = selection;
+  routineStart = sim::timeMs();
+  autonomous();
+  routineEnd = sim::timeMs();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  int only = -1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-v") == 0) {
+      sim::setVerbose(true);
+    } else {
+      only = atoi(argv[i]);
+    }
+  }
+
+  // Model the drivetrain the robot code configured.
+  sim::robot().wheelDiameter = chassis.getWheelDiameter();
+  sim::robot().gearRatio = chassis.getGearRatio();
+  sim::onHoldStop(recordMotionEnd);
+
+  for (selection = 0; selection < autonNum; selection++) {
+    if (only >= 0 && selection != only) continue;
+    sim::setTruePose(0, 0, 0);
+    clock_t hostStart = clock();
+    routineEnd = -1;
+    sim::run(runRoutine, ROUTINE_LIMIT_MS);
+    double hostMs = (clock() - hostStart) * 1000.0 / CLOCKS_PER_SEC;
+
+    printf("%s\n", autonMenuText[selection]);
+    double previous = routineStart;
+    for (int i = 0; i < motionCount; i++) {
+      printf("  motion %2d  %6.0f ms\n", i + 1, motionEnds[i] - previous);
+      previous = motionEnds[i];
+    }
+    if (routineEnd < 0) {
+      printf("  did not finish within %u ms\n", ROUTINE_LIMIT_MS);
+      routineEnd = sim::timeMs();
+    }
+    float x, y, heading;
+    sim::truePose(x, y, heading);
+    Pose pose = chassis.getPose();
+    printf("  total      %6.0f ms (simulated in %.0f ms)\n", routineEnd - routineStart, hostMs);
+    printf("  final pose x %.2f y %.2f heading %.2f (odometry x %.2f y %.2f heading %.2f)\n",
+           x, y, heading, pose.x, pose.y, pose.heading);
+  }
+  return 0;
+}
@@ -0,0 +1,937 @@
+// Host simulator for the VEX V5 API subset in sim/include/v5_vcs.h.
+//
+// Threads are cooperative coroutines driven by a virtual clock: a thread runs
+// until it waits, then the scheduler wakes the thread with the earliest wake
+// time and steps the drivetrain physics up to that time. Nothing sleeps for
+// real, so a 60 s routine finishes in milliseconds and every run is
+// deterministic.
+
+#include "v5.h"
+#include "v5_vcs.h"
+#include "sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <ucontext.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace {
+
+const double INCH = 0.0254;
+const double STEP_US = 1000;
+const int PORT_COUNT = 21;
+const int BUTTON_COUNT = 12;
+const size_t STACK_SIZE = 512 * 1024;
+
+// ---------------------------------------------------------------------------
+//                               robot model
+// ---------------------------------------------------------------------------
+
+sim::RobotModel model = {
+  {vex::PORT12, vex::PORT11, vex::PORT13}, 3,
+  {vex::PORT2, vex::PORT1, vex::PORT3}, 3,
+  {vex::PORT17}, 1,
+  vex::PORT16,
+  2.75f,  // wheel diameter
+  0.75f,  // gear ratio
+  12.0f,  // track width
+  600.0f, // blue cartridge
+  0.35f,  // stall torque of a blue 11 W motor
+  2.5f,   // stall current
+  6.5f,   // mass
+  0.12f,  // inertia
+  2.0f,   // viscous friction
+  3.0f,   // coulomb friction
+  0.0f    // imu drift
+};
+
+enum MotorMode { MODE_STOPPED, MODE_VOLTAGE, MODE_VELOCITY };
+
+struct MotorState {
+  int mode;
+  vex::brakeType brake;
+  double command;       // volts in voltage mode, rpm in velocity mode
+  double defaultRpm;    // velocity used by spin(dir)
+  double freeRpm;
+  double angle;         // shaft angle in degrees
+  double offset;        // subtracted from angle when reading position
+  double velocity;      // shaft speed in rad/s
+  double holdAngle;
+  double torque;
+  double currentA;
+  double volts;
+  double temperature;
+};
+
+MotorState motors[PORT_COUNT];
+bool motorsInitialized = false;
+
+// Robot state in meters and radians, heading clockwise from +y.
+double robotX = 0, robotY = 0, robotTheta = 0;
+double robotV = 0, robotW = 0;
+
+// Inertial sensor state.
+double imuHeadingOffset = 0, imuRotationOffset = 0;
+double imuCalibrationEnd = 0;
+
+// Controller state.
+int axes[4];
+bool buttons[BUTTON_COUNT];
+std::vector<void (*)(void)> pressedCallbacks[BUTTON_COUNT];
+std::vector<void (*)(void)> releasedCallbacks[BUTTON_COUNT];
+
+std::deque<uint8_t> serialIn;
+bool verbose = false;
+void (*holdStopCallback)(double) = 0;
+
+void initMotors() {
+  if (motorsInitialized) return;
+  motorsInitialized = true;
+  for (int i = 0; i < PORT_COUNT; i++) {
+    MotorState &m = motors[i];
+    memset(&m, 0, sizeof(m));
+    m.mode = MODE_STOPPED;
+    m.brake = vex::brakeType::coast;
+    m.freeRpm = 200;
+    m.defaultRpm = 100;
+    m.temperature = 25;
+  }
+}
+
+MotorState &motorAt(int port) {
+  initMotors();
+  if (port < 0 || port >= PORT_COUNT) port = 0;
+  return motors[port];
+}
+
+bool portIn(int port, const int *list, int count) {
+  for (int i = 0; i < count; i++) {
+    if (list[i] == port) return true;
+  }
+  return false;
+}
+
+bool isDrivePort(int port) {
+  return portIn(port, model.leftPorts, model.leftCount) || portIn(port, model.rightPorts, model.rightCount);
+}
+
+// ---------------------------------------------------------------------------
+//                                 physics
+// ---------------------------------------------------------------------------
+
+double clampd(double value, double limit) {
+  if (value > limit) return limit;
+  if (value < -limit) return -limit;
+  return value;
+}
+
+double stallTorque(const MotorState &m) {
+  return model.motorStallTorque * model.motorFreeRpm / m.freeRpm;
+}
+
+// Computes the torque of a motor spinning at omega rad/s from its command.
+double motorTorque(MotorState &m, double omega) {
+  double freeSpeed = m.freeRpm * 2 * M_PI / 60;
+  double stall = stallTorque(m);
+  double volts = 0;
+  if (m.mode == MODE_VOLTAGE) {
+    volts = m.command;
+  } else if (m.mode == MODE_VELOCITY) {
+    double target = m.command * 2 * M_PI / 60;
+    volts = 12 * target / freeSpeed + 2.0 * (target - omega);
+  } else if (m.brake == vex::brakeType::coast) {
+    m.volts = 0;
+    m.torque = 0;
+    m.currentA = 0;
+    return 0;
+  } else if (m.brake == vex::brakeType::hold) {
+    volts = 0.4 * (m.holdAngle - m.angle) - 0.05 * omega;
+  }
+  volts = clampd(volts, 12);
+  double torque = clampd(stall * (volts / 12 - omega / freeSpeed), stall);
+  m.volts = volts;
+  m.torque = torque;
+  m.currentA = fabs(torque) / stall * model.motorStallCurrent;
+  return torque;
+}
+
+void heat(MotorState &m, double dt) {
+  m.temperature += (0.04 * m.currentA * m.currentA - (m.temperature - 25) / 300) * dt;
+}
+
+// Returns the drive force of one side of the drivetrain moving at v m/s.
+double sideForce(const int *ports, int count, double v, double dt) {
+  double radius = model.wheelDiameter / 2 * INCH;
+  double omega = v / (model.gearRatio * radius);
+  double torque = 0;
+  for (int i = 0; i < count; i++) {
+    MotorState &m = motorAt(ports[i]);
+    m.freeRpm = model.motorFreeRpm;
+    torque += motorTorque(m, omega);
+    heat(m, dt);
+  }
+  double force = torque / (model.gearRatio * radius);
+  // Rolling resistance plus dry friction, which can hold a side still.
+  force -= model.viscousFriction * v;
+  if (fabs(v) < 1e-3) {
+    if (fabs(force) < model.coulombFriction) return 0;
+    return force - (force > 0 ? model.coulombFriction : -model.coulombFriction);
+  }
+  return force - (v > 0 ? model.coulombFriction : -model.coulombFriction);
+}
+
+void moveSide(const int *ports, int count, double v, double dt) {
+  double radius = model.wheelDiameter / 2 * INCH;
+  double omega = v / (model.gearRatio * radius);
+  for (int i = 0; i < count; i++) {
+    MotorState &m = motorAt(ports[i]);
+    m.velocity = omega;
+    m.angle += omega * dt * 180 / M_PI;
+  }
+}
+
+void step(double dt) {
+  double halfTrack = model.trackWidth / 2 * INCH;
+  double leftV = robotV + robotW * halfTrack;
+  double rightV = robotV - robotW * halfTrack;
+  double leftF = sideForce(model.leftPorts, model.leftCount, leftV, dt);
+  double rightF = sideForce(model.rightPorts, model.rightCount, rightV, dt);
+
+  robotV += (leftF + rightF) / model.mass * dt;
+  robotW += (leftF - rightF) * halfTrack / model.inertia * dt;
+  if (fabs(robotV) < 1e-4 && leftF == 0 && rightF == 0) robotV = 0;
+  if (fabs(robotW) < 1e-4 && leftF == 0 && rightF == 0) robotW = 0;
+
+  // Integrate along the arc driven during this step.
+  double dTheta = robotW * dt;
+  double distance = robotV * dt;
+  double midTheta = robotTheta + dTheta / 2;
+  robotX += distance * sin(midTheta);
+  robotY += distance * cos(midTheta);
+  robotTheta += dTheta;
+
+  moveSide(model.leftPorts, model.leftCount, robotV + robotW * halfTrack, dt);
+  moveSide(model.rightPorts, model.rightCount, robotV - robotW * halfTrack, dt);
+
+  // Other motors spin a small free load.
+  for (int i = 0; i < PORT_COUNT; i++) {
+    if (isDrivePort(i)) continue;
+    MotorState &m = motors[i];
+    double torque = motorTorque(m, m.velocity);
+    m.velocity += (torque - 0.001 * m.velocity) / 0.002 * dt;
+    m.angle += m.velocity * dt * 180 / M_PI;
+    heat(m, dt);
+  }
+}
+
+// ---------------------------------------------------------------------------
+//                        virtual clock and threads
+// ---------------------------------------------------------------------------
+
+enum CallbackKind { INT_VOID, VOID_VOID, INT_ARG, VOID_ARG };
+
+struct SimThread {
+  int id;
+  ucontext_t context;
+  char *stack;
+  uint64_t wakeTime;
+  uint64_t lastRun;
+  bool finished;
+  bool suspended;
+  int kind;
+  void *callback;
+  void *arg;
+};
+
+std::vector<SimThread *> threads;
+int currentThread = -1;
+ucontext_t schedulerContext;
+uint64_t now = 0;
+uint64_t runCounter = 0;
+
+void advanceTo(uint64_t target) {
+  initMotors();
+  while (now < target) {
+    uint64_t delta = target - now;
+    if (delta > STEP_US) delta = STEP_US;
+    step(delta / 1e6);
+    now += delta;
+  }
+}
+
+void threadEntry(int id) {
+  SimThread *t = threads[id];
+  switch (t->kind) {
+  case INT_VOID:
+    ((int (*)(void))t->callback)();
+    break;
+  case VOID_VOID:
+    ((void (*)(void))t->callback)();
+    break;
+  case INT_ARG:
+    ((int (*)(void *))t->callback)(t->arg);
+    break;
+  case VOID_ARG:
+    ((void (*)(void *))t->callback)(t->arg);
+    break;
+  }
+  t->finished = true;
+}
+
+int spawn(int kind, void *callback, void *arg) {
+  SimThread *t = new SimThread();
+  t->stack = new char[STACK_SIZE];
+  t->wakeTime = now;
+  t->lastRun = 0;
+  t->finished = false;
+  t->suspended = false;
+  t->kind = kind;
+  t->callback = callback;
+  t->arg = arg;
+  int id = threads.size();
+  t->id = id;
+  threads.push_back(t);
+  getcontext(&t->context);
+  t->context.uc_stack.ss_sp = t->stack;
+  t->context.uc_stack.ss_size = STACK_SIZE;
+  t->context.uc_link = &schedulerContext;
+  makecontext(&t->context, (void (*)(void))threadEntry, 1, id);
+  return id;
+}
+
+// Suspends the current thread until the virtual clock reaches wakeTime.
+void sleepUntil(uint64_t wakeTime) {
+  if (currentThread < 0) {
+    // Not inside sim::run, just move the clock.
+    advanceTo(wakeTime);
+    return;
+  }
+  SimThread *t = threads[currentThread];
+  t->wakeTime = wakeTime < now ? now : wakeTime;
+  swapcontext(&t->context, &schedulerContext);
+}
+
+SimThread *pickNext() {
+  SimThread *best = 0;
+  for (size_t i = 0; i < threads.size(); i++) {
+    SimThread *t = threads[i];
+    if (t->finished || t->suspended) continue;
+    if (!best || t->wakeTime < best->wakeTime || (t->wakeTime == best->wakeTime && t->lastRun < best->lastRun)) {
+      best = t;
+    }
+  }
+  return best;
+}
+
+void fireCallbacks(std::vector<void (*)(void)> &callbacks) {
+  for (size_t i = 0; i < callbacks.size(); i++) {
+    spawn(VOID_VOID, (void *)callbacks[i], 0);
+  }
+}
+
+void echo(const char *device, const char *text) {
+  if (!verbose) return;
+  printf("[%8.3f] %-10s %s\n", now / 1e6, device, text);
+}
+
+std::string sdPath(const char *name) {
+  mkdir("sd", 0755);
+  return std::string("sd/") + name;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+//                              simulator API
+// ---------------------------------------------------------------------------
+
+namespace sim {
+
+RobotModel &robot() { return model; }
+
+void run(void (*entry)(void), uint32_t limitMs) {
+  initMotors();
+  for (int i = 0; i < model.leftCount; i++) motorAt(model.leftPorts[i]).freeRpm = model.motorFreeRpm;
+  for (int i = 0; i < model.rightCount; i++) motorAt(model.rightPorts[i]).freeRpm = model.motorFreeRpm;
+  int mainId = spawn(VOID_VOID, (void *)entry, 0);
+  uint64_t limit = now + (uint64_t)limitMs * 1000;
+  while (!threads[mainId]->finished) {
+    SimThread *next = pickNext();
+    if (!next) break;
+    if (next->wakeTime > now) advanceTo(next->wakeTime < limit ? next->wakeTime : limit);
+    if (now >= limit) break;
+    currentThread = next->id;
+    next->lastRun = ++runCounter;
+    swapcontext(&schedulerContext, &next->context);
+    currentThread = -1;
+  }
+}
+
+double timeMs() { return now / 1000.0; }
+
+void truePose(float &x, float &y, float &heading) {
+  x = robotX / INCH;
+  y = robotY / INCH;
+  heading = fmod(fmod(robotTheta * 180 / M_PI, 360) + 360, 360);
+}
+
+void setTruePose(float x, float y, float heading) {
+  // Keep the sensor readings continuous, as if the robot had been carried.
+  double turn = heading - robotTheta * 180 / M_PI;
+  imuHeadingOffset -= turn;
+  imuRotationOffset -= turn;
+  robotX = x * INCH;
+  robotY = y * INCH;
+  robotTheta = heading * M_PI / 180;
+  robotV = 0;
+  robotW = 0;
+}
+
+void setAxis(int axis, int value) {
+  if (axis >= 1 && axis <= 4) axes[axis - 1] = value;
+}
+
+void setButton(int button, bool pressed) {
+  if (button < 0 || button >= BUTTON_COUNT || buttons[button] == pressed) return;
+  buttons[button] = pressed;
+  fireCallbacks(pressed ? pressedCallbacks[button] : releasedCallbacks[button]);
+}
+
+void serialInput(const uint8_t *data, int len) {
+  for (int i = 0; i < len; i++) serialIn.push_back(data[i]);
+}
+
+void setVerbose(bool value) { verbose = value; }
+
+void onHoldStop(void (*callback)(double timeMs)) { holdStopCallback = callback; }
+
+} // namespace sim
+
+// ---------------------------------------------------------------------------
+//                                 C API
+// ---------------------------------------------------------------------------
+
+extern "C" {
+
+int32_t vexSerialReadChar(uint32_t channel) {
+  if (serialIn.empty()) return -1;
+  int32_t c = serialIn.front();
+  serialIn.pop_front();
+  return c;
+}
+
+int32_t vexSerialPeekChar(uint32_t channel) {
+  return serialIn.empty() ? -1 : serialIn.front();
+}
+
+int32_t vexSerialWriteChar(uint32_t channel, uint8_t c) {
+  return vexSerialWriteBuffer(channel, &c, 1);
+}
+
+int32_t vexSerialWriteBuffer(uint32_t channel, uint8_t *data, uint32_t data_len) {
+  if (verbose) {
+    fwrite(data, 1, data_len, stdout);
+  }
+  return data_len;
+}
+
+int32_t vexSerialWriteFree(uint32_t channel) { return 2048; }
+
+} // extern "C"
+
+// ---------------------------------------------------------------------------
+//                               vex classes
+// ---------------------------------------------------------------------------
+
+namespace vex {
+
+void wait(double time, timeUnits units) {
+  double us = units == timeUnits::sec ? time * 1e6 : time * 1e3;
+  if (us < 0) us = 0;
+  sleepUntil(now + (uint64_t)us);
+}
+
+// thread ---------------------------------------------------------------------
+
+thread::thread() : id(-1) {}
+thread::thread(int (*callback)(void)) : id(spawn(INT_VOID, (void *)callback, 0)) {}
+thread::thread(void (*callback)(void)) : id(spawn(VOID_VOID, (void *)callback, 0)) {}
+thread::thread(int (*callback)(void *), void *arg) : id(spawn(INT_ARG, (void *)callback, arg)) {}
+thread::thread(void (*callback)(void *), void *arg) : id(spawn(VOID_ARG, (void *)callback, arg)) {}
+thread::~thread() {}
+
+int32_t thread::get_id() { return id; }
+
+void thread::join() {
+  while (id >= 0 && !threads[id]->finished) wait(1, msec);
+}
+
+void thread::detach() {}
+bool thread::joinable() { return id >= 0 && !threads[id]->finished; }
+
+void thread::interrupt() {
+  if (id < 0) return;
+  threads[id]->finished = true;
+  if (id == currentThread) sleepUntil(now);
+}
+
+void thread::setPriority(int32_t priority) {}
+int32_t thread::priority() { return threadPriorityNormal; }
+
+void thread::swap(thread &t1, thread &t2) {
+  int32_t id = t1.id;
+  t1.id = t2.id;
+  t2.id = id;
+}
+
+int32_t thread::hardware_concurrency() { return 1; }
+
+namespace this_thread {
+int32_t get_id() { return currentThread; }
+void yield() { sleepUntil(now); }
+void sleep_for(uint32_t time_ms) { sleepUntil(now + (uint64_t)time_ms * 1000); }
+void sleep_until(uint32_t time_ms) { sleepUntil((uint64_t)time_ms * 1000); }
+void set_priority(int32_t priority) {}
+int32_t get_priority() { return thread::threadPriorityNormal; }
+} // namespace this_thread
+
+// task -----------------------------------------------------------------------
+
+task::task() : id(-1) {}
+task::task(int (*callback)(void)) : id(spawn(INT_VOID, (void *)callback, 0)) {}
+task::task(int (*callback)(void *), void *arg) : id(spawn(INT_ARG, (void *)callback, arg)) {}
+task::task(int (*callback)(void), int32_t priority) : id(spawn(INT_VOID, (void *)callback, 0)) {}
+task::task(int (*callback)(void *), void *arg, int32_t priority) : id(spawn(INT_ARG, (void *)callback, arg)) {}
+task::~task() {}
+
+bool task::stop() {
+  if (id < 0) return false;
+  threads[id]->finished = true;
+  if (id == currentThread) sleepUntil(now);
+  return true;
+}
+
+void task::suspend() {
+  if (id < 0) return;
+  threads[id]->suspended = true;
+  if (id == currentThread) sleepUntil(now);
+}
+
+void task::resume() {
+  if (id >= 0) threads[id]->suspended = false;
+}
+
+int32_t task::priority() { return taskPriorityNormal; }
+void task::setPriority(int32_t priority) {}
+void task::sleep(uint32_t time) { this_thread::sleep_for(time); }
+void task::yield() { this_thread::yield(); }
+
+// mutex ----------------------------------------------------------------------
+
+mutex::mutex() : owner(-2) {}
+
+void mutex::lock() {
+  while (!try_lock()) wait(1, msec);
+}
+
+bool mutex::try_lock() {
+  if (owner != -2) return false;
+  owner = currentThread;
+  return true;
+}
+
+void mutex::unlock() { owner = -2; }
+
+// timer ----------------------------------------------------------------------
+
+timer::timer() : startTime(now) {}
+
+double timer::time(timeUnits units) {
+  double ms = (now - startTime) / 1000.0;
+  return units == timeUnits::sec ? ms / 1000 : ms;
+}
+
+double timer::value() { return time(timeUnits::sec); }
+void timer::clear() { startTime = now; }
+void timer::reset() { startTime = now; }
+uint32_t timer::system() { return now / 1000; }
+uint64_t timer::systemHighResolution() { return now; }
+
+// color ----------------------------------------------------------------------
+
+const color color::black(0x000000);
+const color color::white(0xFFFFFF);
+const color color::red(0xFF0000);
+const color color::green(0x00FF00);
+const color color::blue(0x0000FF);
+const color color::yellow(0xFFFF00);
+const color color::orange(0xFFA500);
+const color color::cyan(0x00FFFF);
+const color black(0x000000);
+const color white(0xFFFFFF);
+const color red(0xFF0000);
+const color green(0x00FF00);
+const color blue(0x0000FF);
+const color yellow(0xFFFF00);
+const color orange(0xFFA500);
+const color cyan(0x00FFFF);
+
+// motor ----------------------------------------------------------------------
+
+static double gearRpm(gearSetting gears) {
+  switch (gears) {
+  case gearSetting::ratio36_1:
+    return 100;
+  case gearSetting::ratio6_1:
+    return 600;
+  default:
+    return 200;
+  }
+}
+
+motor::motor(int32_t index) : index(index) {}
+motor::motor(int32_t index, bool reverse) : index(index) {}
+motor::motor(int32_t index, gearSetting gears) : index(index) { motorAt(index).freeRpm = gearRpm(gears); }
+motor::motor(int32_t index, gearSetting gears, bool reverse) : index(index) { motorAt(index).freeRpm = gearRpm(gears); }
+
+bool motor::installed() {
+  return isDrivePort(index) || portIn(index, model.otherPorts, model.otherCount);
+}
+
+void motor::setReversed(bool value) {}
+
+void motor::setVelocity(double velocity, velocityUnits units) {
+  MotorState &m = motorAt(index);
+  m.defaultRpm = units == velocityUnits::rpm ? velocity : (units == velocityUnits::dps ? velocity / 6 : velocity * m.freeRpm / 100);
+}
+
+void motor::setVelocity(double velocity, percentUnits units) { setVelocity(velocity, velocityUnits::pct); }
+void motor::setStopping(brakeType mode) { motorAt(index).brake = mode; }
+void motor::setMaxTorque(double value, percentUnits units) {}
+
+void motor::setPosition(double value, rotationUnits units) {
+  MotorState &m = motorAt(index);
+  double degrees = units == rotationUnits::rev ? value * 360 : value;
+  m.offset = m.angle - degrees;
+}
+
+void motor::resetPosition() { setPosition(0, rotationUnits::deg); }
+
+void motor::spin(directionType dir) {
+  MotorState &m = motorAt(index);
+  spin(dir, m.defaultRpm, velocityUnits::rpm);
+}
+
+void motor::spin(directionType dir, double velocity, velocityUnits units) {
+  MotorState &m = motorAt(index);
+  double rpm = units == velocityUnits::rpm ? velocity : (units == velocityUnits::dps ? velocity / 6 : velocity * m.freeRpm / 100);
+  m.mode = MODE_VELOCITY;
+  m.command = dir == directionType::rev ? -rpm : rpm;
+}
+
+void motor::spin(directionType dir, double velocity, percentUnits units) { spin(dir, velocity, velocityUnits::pct); }
+
+void motor::spin(directionType dir, double voltage, voltageUnits units) {
+  MotorState &m = motorAt(index);
+  double volts = units == voltageUnits::mV ? voltage / 1000 : voltage;
+  m.mode = MODE_VOLTAGE;
+  m.command = dir == directionType::rev ? -volts : volts;
+}
+
+void motor::stop() { stop(motorAt(index).brake); }
+
+void motor::stop(brakeType mode) {
+  MotorState &m = motorAt(index);
+  m.mode = MODE_STOPPED;
+  m.brake = mode;
+  m.holdAngle = m.angle;
+}
+
+bool motor::isSpinning() { return fabs(motorAt(index).velocity) > 0.1; }
+bool motor::isDone() { return !isSpinning(); }
+
+double motor::position(rotationUnits units) {
+  MotorState &m = motorAt(index);
+  double degrees = m.angle - m.offset;
+  return units == rotationUnits::rev ? degrees / 360 : degrees;
+}
+
+double motor::velocity(velocityUnits units) {
+  MotorState &m = motorAt(index);
+  double rpm = m.velocity * 60 / (2 * M_PI);
+  if (units == velocityUnits::rpm) return rpm;
+  if (units == velocityUnits::dps) return rpm * 6;
+  return rpm / m.freeRpm * 100;
+}
+
+double motor::velocity(percentUnits units) { return velocity(velocityUnits::pct); }
+double motor::current(currentUnits units) { return motorAt(index).currentA; }
+double motor::current(percentUnits units) { return motorAt(index).currentA / model.motorStallCurrent * 100; }
+double motor::voltage(voltageUnits units) {
+  double volts = motorAt(index).volts;
+  return units == voltageUnits::mV ? volts * 1000 : volts;
+}
+double motor::power(powerUnits units) { return fabs(motorAt(index).volts * motorAt(index).currentA); }
+double motor::torque(torqueUnits units) { return motorAt(index).torque; }
+double motor::efficiency(percentUnits units) { return 50; }
+
+double motor::temperature(temperatureUnits units) {
+  double t = motorAt(index).temperature;
+  return units == temperatureUnits::fahrenheit ? t * 9 / 5 + 32 : t;
+}
+
+double motor::temperature(percentUnits units) { return (motorAt(index).temperature - 25) / 45 * 100; }
+
+// motor_group ----------------------------------------------------------------
+
+#define FOR_EACH_MOTOR(statement)         \
+  for (int i = 0; i < motorCount; i++) { \
+    motor m(ports[i]);                   \
+    statement;                           \
+  }
+
+void motor_group::setVelocity(double velocity, velocityUnits units) { FOR_EACH_MOTOR(m.setVelocity(velocity, units)) }
+void motor_group::setVelocity(double velocity, percentUnits units) { FOR_EACH_MOTOR(m.setVelocity(velocity, units)) }
+void motor_group::setStopping(brakeType mode) { FOR_EACH_MOTOR(m.setStopping(mode)) }
+void motor_group::setPosition(double value, rotationUnits units) { FOR_EACH_MOTOR(m.setPosition(value, units)) }
+void motor_group::resetPosition() { FOR_EACH_MOTOR(m.resetPosition()) }
+void motor_group::spin(directionType dir) { FOR_EACH_MOTOR(m.spin(dir)) }
+void motor_group::spin(directionType dir, double velocity, velocityUnits units) { FOR_EACH_MOTOR(m.spin(dir, velocity, units)) }
+void motor_group::spin(directionType dir, double velocity, percentUnits units) { FOR_EACH_MOTOR(m.spin(dir, velocity, units)) }
+void motor_group::spin(directionType dir, double voltage, voltageUnits units) { FOR_EACH_MOTOR(m.spin(dir, voltage, units)) }
+void motor_group::stop() { FOR_EACH_MOTOR(m.stop()) }
+
+void motor_group::stop(brakeType mode) {
+  FOR_EACH_MOTOR(m.stop(mode))
+  if (mode == brakeType::hold && holdStopCallback && motorCount > 0 && portIn(ports[0], model.leftPorts, model.leftCount)) {
+    holdStopCallback(now / 1000.0);
+  }
+}
+
+bool motor_group::isSpinning() {
+  FOR_EACH_MOTOR(if (m.isSpinning()) return true)
+  return false;
+}
+
+// Like the V5 SDK, position and velocity report the first motor of the group.
+double motor_group::position(rotationUnits units) { return motorCount ? motor(ports[0]).position(units) : 0; }
+double motor_group::velocity(velocityUnits units) { return motorCount ? motor(ports[0]).velocity(units) : 0; }
+double motor_group::velocity(percentUnits units) { return motorCount ? motor(ports[0]).velocity(units) : 0; }
+double motor_group::voltage(voltageUnits units) { return motorCount ? motor(ports[0]).voltage(units) : 0; }
+
+double motor_group::current(currentUnits units) {
+  double total = 0;
+  FOR_EACH_MOTOR(total += m.current(units))
+  return total;
+}
+
+double motor_group::current(percentUnits units) { return motorCount ? motor(ports[0]).current(units) : 0; }
+
+double motor_group::power(powerUnits units) {
+  double total = 0;
+  FOR_EACH_MOTOR(total += m.power(units))
+  return total;
+}
+
+double motor_group::torque(torqueUnits units) {
+  double total = 0;
+  FOR_EACH_MOTOR(total += m.torque(units))
+  return total;
+}
+
+double motor_group::efficiency(percentUnits units) { return 50; }
+double motor_group::temperature(temperatureUnits units) { return motorCount ? motor(ports[0]).temperature(units) : 0; }
+double motor_group::temperature(percentUnits units) { return motorCount ? motor(ports[0]).temperature(units) : 0; }
+
+// inertial -------------------------------------------------------------------
+
+inertial::inertial(int32_t index) : index(index) {}
+
+bool inertial::installed() { return index == model.inertialPort; }
+void inertial::calibrate(int32_t value) { imuCalibrationEnd = now + 2e6; }
+void inertial::startCalibration(int32_t value) { calibrate(value); }
+bool inertial::isCalibrating() { return now < imuCalibrationEnd; }
+
+static double trueRotation() { return robotTheta * 180 / M_PI + model.imuDrift * now / 1e6; }
+
+void inertial::resetHeading() { setHeading(0, rotationUnits::deg); }
+void inertial::resetRotation() { setRotation(0, rotationUnits::deg); }
+void inertial::setHeading(double value, rotationUnits units) { imuHeadingOffset = value - trueRotation(); }
+void inertial::setRotation(double value, rotationUnits units) { imuRotationOffset = value - trueRotation(); }
+
+double inertial::heading(rotationUnits units) {
+  double h = fmod(fmod(trueRotation() + imuHeadingOffset, 360) + 360, 360);
+  return units == rotationUnits::rev ? h / 360 : h;
+}
+
+double inertial::rotation(rotationUnits units) {
+  double r = trueRotation() + imuRotationOffset;
+  return units == rotationUnits::rev ? r / 360 : r;
+}
+
+double inertial::angle(rotationUnits units) { return heading(units); }
+
+double inertial::gyroRate(axisType axis, velocityUnits units) {
+  if (axis != axisType::zaxis) return 0;
+  double dps = robotW * 180 / M_PI + model.imuDrift;
+  return units == velocityUnits::rpm ? dps / 6 : dps;
+}
+
+double inertial::acceleration(axisType axis) { return 0; }
+
+// controller -----------------------------------------------------------------
+
+int32_t controller::axis::value() { return axes[id]; }
+int32_t controller::axis::position(percentUnits units) { return axes[id]; }
+
+bool controller::button::pressing() { return buttons[id]; }
+void controller::button::pressed(void (*callback)(void)) { pressedCallbacks[id].push_back(callback); }
+void controller::button::released(void (*callback)(void)) { releasedCallbacks[id].push_back(callback); }
+
+static char controllerLine[64];
+
+void controller::lcd::setCursor(int32_t row, int32_t col) {}
+int32_t controller::lcd::column() { return 1; }
+int32_t controller::lcd::row() { return 1; }
+
+void controller::lcd::print(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vsnprintf(controllerLine, sizeof(controllerLine), format, args);
+  va_end(args);
+  echo("controller", controllerLine);
+}
+
+void controller::lcd::print(int32_t value) { print("%d", (int)value); }
+void controller::lcd::print(double value) { print("%.2f", value); }
+void controller::lcd::clearScreen() {}
+void controller::lcd::clearLine(int32_t number) {}
+void controller::lcd::clearLine() {}
+void controller::lcd::newLine() {}
+
+controller::controller() : controller(controllerType::primary) {}
+
+controller::controller(controllerType id)
+  : type(id), Axis1(0), Axis2(1), Axis3(2), Axis4(3),
+    ButtonL1(0), ButtonL2(1), ButtonR1(2), ButtonR2(3), ButtonUp(4), ButtonDown(5),
+    ButtonLeft(6), ButtonRight(7), ButtonX(8), ButtonB(9), ButtonY(10), ButtonA(11) {}
+
+void controller::rumble(const char *pattern) { echo("rumble", pattern); }
+bool controller::installed() { return true; }
+
+// brain ----------------------------------------------------------------------
+
+static char brainLine[128];
+
+void brain::lcd::setFont(fontType font) {}
+void brain::lcd::setPenColor(const color &c) {}
+void brain::lcd::setFillColor(const color &c) {}
+void brain::lcd::setPenWidth(uint32_t width) {}
+void brain::lcd::setCursor(int32_t row, int32_t col) {}
+int32_t brain::lcd::column() { return 1; }
+int32_t brain::lcd::row() { return 1; }
+
+void brain::lcd::print(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vsnprintf(brainLine, sizeof(brainLine), format, args);
+  va_end(args);
+  echo("brain", brainLine);
+}
+
+void brain::lcd::print(int32_t value) { print("%d", (int)value); }
+void brain::lcd::print(double value) { print("%.2f", value); }
+
+void brain::lcd::printAt(int32_t x, int32_t y, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  vsnprintf(brainLine, sizeof(brainLine), format, args);
+  va_end(args);
+  echo("brain", brainLine);
+}
+
+void brain::lcd::clearScreen() {}
+void brain::lcd::clearScreen(const color &c) {}
+void brain::lcd::clearLine(int32_t number) {}
+void brain::lcd::clearLine() {}
+void brain::lcd::newLine() {}
+void brain::lcd::drawPixel(int32_t x, int32_t y) {}
+void brain::lcd::drawLine(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {}
+void brain::lcd::drawRectangle(int32_t x, int32_t y, int32_t width, int32_t height) {}
+void brain::lcd::drawRectangle(int32_t x, int32_t y, int32_t width, int32_t height, const color &c) {}
+void brain::lcd::drawCircle(int32_t x, int32_t y, int32_t radius) {}
+bool brain::lcd::pressing() { return false; }
+int32_t brain::lcd::xPosition() { return 0; }
+int32_t brain::lcd::yPosition() { return 0; }
+bool brain::lcd::render() { return true; }
+
+uint32_t brain::battery::capacity(percentUnits units) { return 100; }
+double brain::battery::temperature(percentUnits units) { return 30; }
+
+double brain::battery::voltage(voltageUnits units) {
+  double amps = 0;
+  for (int i = 0; i < PORT_COUNT; i++) amps += motors[i].currentA;
+  double volts = 12.8 - 0.05 * amps;
+  return units == voltageUnits::mV ? volts * 1000 : volts;
+}
+
+double brain::battery::current(currentUnits units) {
+  double amps = 0;
+  for (int i = 0; i < PORT_COUNT; i++) amps += motors[i].currentA;
+  return amps;
+}
+
+bool brain::sdcard::isInserted() { return true; }
+
+int32_t brain::sdcard::size(const char *name) {
+  struct stat info;
+  if (stat(sdPath(name).c_str(), &info) != 0) return 0;
+  return info.st_size;
+}
+
+bool brain::sdcard::exists(const char *name) {
+  struct stat info;
+  return stat(sdPath(name).c_str(), &info) == 0;
+}
+
+int32_t brain::sdcard::loadfile(const char *name, uint8_t *buffer, int32_t len) {
+  FILE *file = fopen(sdPath(name).c_str(), "rb");
+  if (!file) return 0;
+  int32_t count = fread(buffer, 1, len, file);
+  fclose(file);
+  return count;
+}
+
+int32_t brain::sdcard::savefile(const char *name, uint8_t *buffer, int32_t len) {
+  FILE *file = fopen(sdPath(name).c_str(), "wb");
+  if (!file) return 0;
+  int32_t count = fwrite(buffer, 1, len, file);
+  fclose(file);
+  return count;
+}
+
+int32_t brain::sdcard::appendfile(const char *name, uint8_t *buffer, int32_t len) {
+  FILE *file = fopen(sdPath(name).c_str(), "ab");
+  if (!file) return 0;
+  int32_t count = fwrite(buffer, 1, len, file);
+  fclose(file);
+  return count;
+}
+
+// competition ----------------------------------------------------------------
+
+competition::competition() {}
+void competition::autonomous(void (*callback)(void)) {}
+void competition::drivercontrol(void (*callback)(void)) {}
+bool competition::isEnabled() { return true; }
+bool competition::isDriverControl() { return false; }
+bool competition::isAutonomous() { return true; }
+bool competition::isCompetitionSwitch() { return false; }
+bool competition::isFieldControl() { return false; }
+
+} // namespace vex
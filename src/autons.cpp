@@ -5,7 +5,12 @@ int autonTestStep = 0;                // Current step in auton test mode
 // The first autonomous routine.
 void sampleAuton1() {
   // Example: drive forward a tile distance
-  chassis.driveDistance(24);
+  // and start the intake halfway there without stopping.
+  MotionHandle motion = chassis.driveDistanceAsync(24);
+  motion.waitUntilTraveled(12);
+  intake();
+  motion.waitUntilSettled();
+  stopRollers();
 }
 
 // The second autonomous routine.
@@ -14,6 +19,9 @@ void sampleAuton2() {
   chassis.driveDistance(-12, 6);
   chassis.turnToHeading(0, 6);
   chassis.driveDistance(12, 6);
+  // Example: curve right along a quarter circle, then turn back in place with an arc of radius 0.
+  chassis.driveArc(12, 90, 6, 3);
+  chassis.driveArc(0, -90);
 }
 
 // A long autonomous routine, e.g. skill.
@@ -50,6 +58,10 @@ void runAutonItem() {
   case 2:
     sampleSkill();
     break;
+  default:
+    // The scripts and recorded driver runs on the SD card come after the routines in autonMenuText.
+    runSdCardAuton();
+    break;
     }
 }
 
@@ -66,8 +78,10 @@ char const * autonMenuText[] = {
 //               Code below are not specific to any game
 // ----------------------------------------------------------------------------
 
-int autonNum;                         // Total number of autons, automatically calculated based on the size of the autonMenuText array
+int builtinAutonNum = sizeof(autonMenuText) / sizeof(autonMenuText[0]); // Number of autons in the autonMenuText array, automatically calculated
+int autonNum = builtinAutonNum;       // Total number of autons, including the scripts and driver recordings on the SD card
 bool autonTestMode = false;           // Indicates if in test mode
+bool autonTestResume = false;         // Runs the rest of the auton from the current step, even in test mode
 bool exitAutonMenu = false;           // Flag to exit the autonomous menu
 bool enableEndGameTimer = false;      // Flag to indicate if endgame timer is enabled 
 const int END_GAME_SECONDS = 85;      // Endgame reminder starts at 85 seconds
@@ -77,32 +91,81 @@ void autonomous(void) {
   // Exits the autonomous menu.
   exitAutonMenu = true;
   enableEndGameTimer = true;
+  // Waits for the inertial sensor and odometry, if the match starts while the robot is still booting.
+  boot.waitForAll();
   // Runs the selected autonomous routine.
+  runTimedAutonItem();
+}
+
+// Counts the autons again, after the scripts or recordings on the SD card have changed.
+void updateAutonNum() {
+  autonNum = builtinAutonNum + scripts.getCount() + recorder.getCount();
+}
+
+// Gets the menu name of an autonomous routine: a name from autonMenuText, a script or a recording.
+const char* autonName(int selection) {
+  if (selection < builtinAutonNum) return autonMenuText[selection];
+  selection -= builtinAutonNum;
+  if (selection < scripts.getCount()) return scripts.getName(selection);
+  return recorder.getName(selection - scripts.getCount());
+}
+
+// Runs the selected script or plays the selected driver recording.
+// In test mode a script runs one step per call, like the autons that use continueAutonStep().
+void runSdCardAuton() {
+  int selection = currentAutonSelection - builtinAutonNum;
+  if (selection < scripts.getCount()) {
+    autonTestStep = scripts.run(selection, autonTestStep, autonTestMode && !autonTestResume);
+    return;
+  }
+  recorder.play(selection - scripts.getCount());
+}
+
+// Runs the selected autonomous routine, timing each motion, then shows where the time went
+// on the brain screen and over serial and saves it to the SD card.
+void runTimedAutonItem() {
+  motionTimer.startRun(autonName(currentAutonSelection), autonTestStep);
   runAutonItem();
+  motionTimer.finishRun();
+  motionTimer.report();
+  motionTimer.save();
 }
 
 // This function prints the selected autonomous routine to the brain and controller screens.
 void printMenuItem() {
   // Clears the brain screen.
-  Brain.Screen.clearScreen();
-  // Sets the cursor to the third row, first column.
-  Brain.Screen.setCursor(3, 1);
+  display.clearBrain();
+  // A script can be uploaded at any time.
+  updateAutonNum();
   currentAutonSelection = currentAutonSelection % autonNum;
-  // Prints the selected autonomous routine name.
-  Brain.Screen.print("%s", autonMenuText[currentAutonSelection]);
-  printControllerScreen(autonMenuText[currentAutonSelection]);
+  // Prints the selected autonomous routine name on the third row.
+  display.printBrain(3, "%s", autonName(currentAutonSelection));
+  // The menu shows while the inertial sensor calibrates, which needs the robot to stay still.
+  if (!boot.isFinished()) display.printBrain(5, "calibrating, do not move");
+  printControllerScreen(autonName(currentAutonSelection));
+}
+
+// Remembers the selected auton across restarts.
+void saveAutonSelection() {
+  configStore.set("auton", currentAutonSelection);
+  configStore.save();
 }
 
 // This function displays the autonomous menu on the brain screen.
 void showAutonMenu() {
-  autonNum = sizeof(autonMenuText) / sizeof(autonMenuText[0]);
   autonTestStep = 0;
 
-  Brain.Screen.setFont(mono30);
+  display.setBrainFont(mono30);
   printMenuItem();
+  bool booting = !boot.isFinished();
 
   // This loop runs until the autonomous menu is exited.
   while (!exitAutonMenu) {
+    // Shows the menu again without the calibration note once the boot is done.
+    if (booting && boot.isFinished()) {
+      booting = false;
+      printMenuItem();
+    }
     // If the brain screen is pressed, cycle through the autonomous routines.
     if (Brain.Screen.pressing()) {
       // Waits until the finger is lifted up from the screen.
@@ -112,12 +175,13 @@ void showAutonMenu() {
       // Cycles through the autonomous routines.
       currentAutonSelection = (currentAutonSelection + 1) % autonNum;
       printMenuItem();
-      controller1.rumble(".");
+      display.rumble(".");
+      saveAutonSelection();
     }
     // This wait prevents the loop from using too much CPU time.
     wait(50, msec);
   }
-  Brain.Screen.setFont(mono20);
+  display.setBrainFont(mono20);
 }
 
 // This function is a thread that runs in the background to remind the driver of the end game.
@@ -128,15 +192,7 @@ void endgameTimer() {
   }
   if (enableEndGameTimer)
   {
-    printControllerScreen("end game");
-    controller1.rumble("-");
-  }
-
-  // Checks the motors health every 60 seconds in drive practice
-  while(true)
-  {
-    wait(60, seconds);
-    if (!autonTestMode) checkMotors(NUMBER_OF_MOTORS);
+    display.alert("end game", "-");
   }
 }
 
@@ -153,38 +209,85 @@ void exitAuton()
 bool setupinertialSensor() {
   wait(100, msec);
   if (!chassis.inertialSensor.installed()) {
-    printControllerScreen("inertial sensor failure");
-    controller1.rumble("---");
-    wait(2, seconds);
+    display.alert("inertial sensor failure", "---");
     return false;  
   }
 
   chassis.inertialSensor.calibrate(3);
-  // Waits until the inertial sensor is calibrated.
+  // Waits until the inertial sensor is calibrated. The other boot stages run meanwhile,
+  // so checking often costs nothing and lets the stages that need the sensor start sooner.
   while (chassis.inertialSensor.isCalibrating()) {
-    wait(100, msec);
+    wait(10, msec);
   }
   // Rumbles the controller to indicate that the inertialSensor is calibrated.
-  controller1.rumble(".");
+  display.rumble(".");
+  return true;
+}
+
+// Checks the motors, then keeps watching them in the background.
+bool checkMotors() {
+  bool motorsSetupSuccess = health.check();
+  health.start();
+  return motorsSetupSuccess;
+}
+
+// Sets the parameters of the chassis, with the tuning saved on the SD card. None of them need the inertial sensor.
+bool loadChassisDefaults() {
+  setChassisDefaults();
+  return true;
+}
+
+// Starts tracking the robot's position on the field from the calibrated inertial sensor.
+bool startOdometry() {
+  // Sets the heading of the chassis to the current heading of the inertial sensor.
+  chassis.setHeading(chassis.inertialSensor.heading());
+  chassis.startOdometry();
+  return true;
+}
+
+// Adds the scripts and the driver recordings on the SD card to the autonomous menu.
+// The scripts are parsed here, so the autons do not read the SD card during the match.
+bool loadSdCard() {
+  // Records every control tick to the SD card, if one is inserted.
+  telemetry.start();
+  registerScriptActions();
+  scripts.load();
+  recorder.scan();
+  updateAutonNum();
+  return true;
+}
+
+// Registers the buttons for autonomous testing, once the sensors and motors have passed their checks.
+bool registerTestButtons() {
+  registerAutonTestButtons();
   return true;
 }
 
 // This function is called before the autonomous period starts.
+// The setup runs as a boot pipeline: the inertial sensor calibrates while the motors are
+// checked, the chassis is set up and the SD card is read, and the menu shows as soon as the
+// autons are known instead of after the calibration.
 void pre_auton() {
-  // Sets up the inertialSensor.
-  bool inertialSensorSetupSuccess = setupinertialSensor();
+  // Starts the task that writes to the controller and brain screens.
+  display.start();
 
-  bool motorsSetupSuccess = true;
+  uint32_t inertialStage = boot.addStage("inertial", setupinertialSensor);
+  uint32_t motorStage = boot.addStage("motors", checkMotors);
+  uint32_t chassisStage = boot.addStage("chassis", loadChassisDefaults);
+  uint32_t odometryStage = boot.addStage("odometry", startOdometry, inertialStage | chassisStage);
+  uint32_t sdCardStage = boot.addStage("sd card", loadSdCard);
+  boot.addStage("test buttons", registerTestButtons, odometryStage | motorStage);
+  boot.start();
 
-  // Checks the motors.
-  motorsSetupSuccess = checkMotors(NUMBER_OF_MOTORS);
-  //set the parameters for the chassis
-  setChassisDefaults();
-  // Shows the autonomous menu and register the buttons for autonomous testing.
-  if(inertialSensorSetupSuccess && motorsSetupSuccess) {
-    showAutonMenu();
-    registerAutonTestButtons();
-  }
+  // Shows the autonomous menu once the autons on the SD card are counted, at the auton selected last time.
+  boot.waitFor(sdCardStage | chassisStage);
+  currentAutonSelection = configStore.get().autonSelection;
+  if (currentAutonSelection < 0) currentAutonSelection = 0;
+  showAutonMenu();
+
+  // The buttons must be registered before main() starts the input task.
+  boot.waitForAll();
+  boot.report();
 }
 
 
@@ -195,79 +298,209 @@ void pre_auton() {
 bool continueAutonStep()
 {
   autonTestStep++;
-  if (autonTestMode) return false; // If in test mode, stop here for testing.
+  motionTimer.setStep(autonTestStep);
+  if (autonTestMode && !autonTestResume) return false; // If in test mode, stop here for testing.
   return true; 
 }
 
-void autonTestButtonCheck()
+// Shows the result of an autotune run: the constants on the controller, details on the brain screen.
+void showAutotuneResult(const char* name, AutotuneResult result)
 {
-    // within 5 seconds of driver control.
-  while (Brain.Timer.time(sec) < 5 && !autonTestMode) {
-    if (controller1.ButtonA.pressing())
-    {
-      wait(500, msec);
-      if (controller1.ButtonA.pressing())
-      {
-        controller1.rumble("-");
-        printControllerScreen("Test mode: ON");
-        waitUntil(!controller1.ButtonA.pressing());
-        showAutonMenu();
-        autonTestMode = true;
-        wait(1, seconds);
-        break;
-      }
-    }
-    wait(50, msec);
+  display.clearController();
+  display.printController(1, "%s tune: %s", name, result.success ? "done" : "failed");
+  display.printController(2, "%.3g %.3g %.3g %.3g", result.kp, result.ki, result.kd, result.starti);
+  display.printController(3, "%.0fms over %.2f", result.settleTime, result.overshoot);
+
+  display.clearBrain();
+  display.printBrain(1, "%s autotune %s", name, result.success ? "done" : "failed");
+  display.printBrain(3, "relay test: Ku %.3f  Tu %.0f ms", result.ultimateGain, result.ultimatePeriod);
+  display.printBrain(4, "candidates passed: %d of %d", result.passed, result.candidates);
+  display.printBrain(5, "kp %.4f  ki %.4f  kd %.4f  starti %.2f", result.kp, result.ki, result.kd, result.starti);
+  display.printBrain(6, "settle time %.0f ms  overshoot %.2f", result.settleTime, result.overshoot);
+}
+
+// True while a test action started from a button is running.
+bool testActionRunning = false;
+// The test action to run on the test action thread.
+void (*testAction)() = NULL;
+
+// Runs the test action, then accepts the test buttons again.
+void testActionTask()
+{
+  testAction();
+  chassis.stop(coast);
+  testActionRunning = false;
+}
+
+// Starts a long test action on its own thread, so the input task keeps sampling the buttons.
+void startTestAction(void (*action)())
+{
+  testActionRunning = true;
+  testAction = action;
+  thread testActionThread = thread(testActionTask);
+}
+
+// Returns true if the test buttons should act: in test mode and not running a test action.
+bool testButtonsActive()
+{
+  return autonTestMode && !testActionRunning;
+}
+
+// Runs the selected autonomous routine for testing and displays the run time.
+void runTestAuton()
+{
+  double t1 = Brain.Timer.time(sec);
+  runTimedAutonItem();
+  double t2 = Brain.Timer.time(sec);
+  char timeMsg[30];
+  sprintf(timeMsg, "run time: %.1f", t2-t1);
+  printControllerScreen(timeMsg);
+}
+
+// Runs the selected autonomous routine from the current step to the end.
+void runTestAutonToEnd()
+{
+  autonTestResume = true;
+  runTestAuton();
+  autonTestResume = false;
+}
+
+// Keeps the constants an autotune found across restarts, in the config store.
+void saveAutotuneResult(const char* pid, AutotuneResult result)
+{
+  if (!result.success) return;
+  const char* suffixes[] = {"kp", "ki", "kd", "starti"};
+  float values[] = {result.kp, result.ki, result.kd, result.starti};
+  for (int i = 0; i < 4; i++) {
+    char name[24];
+    snprintf(name, sizeof(name), "%s_%s", pid, suffixes[i]);
+    configStore.set(name, values[i]);
   }
-  while(true)
-  {
-    if (autonTestMode) 
-    {
-      if(controller1.ButtonRight.pressing())
-      {
-        waitUntil(!controller1.ButtonRight.pressing());
-        controller1.rumble(".");
-        // Scroll through the auton menu
-        currentAutonSelection = (currentAutonSelection + 1) % autonNum;
-        wait(0.5, sec);
-        showAutonMenu();
-      }
-      if(controller1.ButtonLeft.pressing())
-      {
-        waitUntil(!controller1.ButtonLeft.pressing());
-        changeDriveMode();
-        wait(0.5, sec);
-      }
-      if(controller1.ButtonDown.pressing())
-      {
-        waitUntil(!controller1.ButtonDown.pressing());
-        controller1.rumble(".");
-        // Go to the next step.
-        autonTestStep++;
-        char msg[30];
-        sprintf(msg, "Step: %d", autonTestStep);
-        printControllerScreen(msg);
-      }
-      if(controller1.ButtonA.pressing())
-      {
-        waitUntil(!controller1.ButtonA.pressing());
-        //run the selected autonomous routine for testing and displays the run time.
-        controller(primary).rumble(".");
-        double t1 = Brain.Timer.time(sec);
-        runAutonItem(); 
-        double t2 = Brain.Timer.time(sec);
-        char timeMsg[30];
-        sprintf(timeMsg, "run time: %.1f", t2-t1);
-        printControllerScreen(timeMsg);
-        chassis.stop(coast);
-      }
-    } 
-    wait(100, msec);
+  configStore.save();
+}
+
+// Autotunes the turn PID, allowing 1 degree of overshoot, and applies and saves the result.
+void runTurnAutotune()
+{
+  AutotuneResult result = chassis.autotuneTurn(1);
+  showAutotuneResult("Turn", result);
+  saveAutotuneResult("turn", result);
+}
+
+// Autotunes the drive PID, allowing 0.5 inch of overshoot, and applies and saves the result.
+// The robot drives 24 inches forward and back, so give it room.
+void runDriveAutotune()
+{
+  AutotuneResult result = chassis.autotuneDrive(0.5);
+  showAutotuneResult("Drive", result);
+  saveAutotuneResult("drive", result);
+}
+
+// Holding A within 5 seconds of driver control turns on test mode.
+void testButtonAHeld()
+{
+  if (autonTestMode || Brain.Timer.time(sec) >= 5) return;
+  display.rumble("-");
+  printControllerScreen("Test mode: ON");
+  showAutonMenu();
+  autonTestMode = true;
+}
+
+// Runs the selected auton.
+void testButtonAPressed()
+{
+  if (!testButtonsActive()) return;
+  display.rumble(".");
+  startTestAction(runTestAuton);
+}
+
+// Resumes the selected auton from the current step and runs it to the end.
+void testButtonYPressed()
+{
+  if (!testButtonsActive()) return;
+  display.rumble(".");
+  startTestAction(runTestAutonToEnd);
+}
+
+// Scrolls through the auton menu.
+void testButtonRightPressed()
+{
+  if (!testButtonsActive()) return;
+  display.rumble(".");
+  currentAutonSelection = (currentAutonSelection + 1) % autonNum;
+  saveAutonSelection();
+  showAutonMenu();
+}
+
+// Switches the drive mode.
+void testButtonLeftPressed()
+{
+  if (!testButtonsActive()) return;
+  changeDriveMode();
+}
+
+// Goes to the next step.
+void testButtonDownPressed()
+{
+  if (!testButtonsActive()) return;
+  display.rumble(".");
+  autonTestStep++;
+  char msg[30];
+  sprintf(msg, "Step: %d", autonTestStep);
+  printControllerScreen(msg);
+}
+
+// Autotunes the turn PID.
+void testButtonUpPressed()
+{
+  if (!testButtonsActive()) return;
+  display.rumble(".");
+  printControllerScreen("Tuning turn PID");
+  startTestAction(runTurnAutotune);
+}
+
+// Autotunes the drive PID.
+void testButtonXPressed()
+{
+  if (!testButtonsActive()) return;
+  display.rumble(".");
+  printControllerScreen("Tuning drive PID");
+  startTestAction(runDriveAutotune);
+}
+
+// Starts recording the driver, or stops and saves the recording as the next recN auton.
+void testButtonBPressed()
+{
+  if (!testButtonsActive()) return;
+  if (!recorder.isRecording()) {
+    display.rumble(".");
+    printControllerScreen("Recording");
+    recorder.startRecording(DRIVE_MODE);
+    return;
+  }
+  int number = recorder.stopRecording();
+  updateAutonNum();
+  char msg[30];
+  if (number > 0) {
+    sprintf(msg, "Saved rec%d", number);
+    display.rumble("-");
+  } else {
+    sprintf(msg, "Recording not saved");
+    display.rumble("---");
   }
+  printControllerScreen(msg);
 }
 
-// in background, check the controller button press for autonomous testing.
+// Registers the handlers of the buttons for autonomous testing with the input dispatcher.
 void registerAutonTestButtons()
 {
-  thread autonTestButtonThread = thread(autonTestButtonCheck);
+  input.on(BUTTON_A, INPUT_HOLD, testButtonAHeld);
+  input.on(BUTTON_A, INPUT_PRESS, testButtonAPressed);
+  input.on(BUTTON_RIGHT, INPUT_PRESS, testButtonRightPressed);
+  input.on(BUTTON_LEFT, INPUT_PRESS, testButtonLeftPressed);
+  input.on(BUTTON_DOWN, INPUT_PRESS, testButtonDownPressed);
+  input.on(BUTTON_UP, INPUT_PRESS, testButtonUpPressed);
+  input.on(BUTTON_X, INPUT_PRESS, testButtonXPressed);
+  input.on(BUTTON_B, INPUT_PRESS, testButtonBPressed);
+  input.on(BUTTON_Y, INPUT_PRESS, testButtonYPressed);
 }
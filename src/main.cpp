@@ -7,45 +7,10 @@ using namespace vex;
 // A global instance of competition
 competition Competition;
 
-void pollCommandMessages()
-{
-  static FILE* serialPort = nullptr;
-  
-  // Open port once
-  if (serialPort == nullptr) {
-    serialPort = fopen("/dev/serial1", "r");
-    if (serialPort == nullptr) return;
-  }
-
-  char buffer[256];
-  if (fgets(buffer, sizeof(buffer), serialPort) == nullptr) return;
-
-  // Simple trim and check
-  std::string command(buffer);
-  command.erase(0, command.find_first_not_of(" \t\r\n"));
-  command.erase(command.find_last_not_of(" \t\r\n") + 1);
-  
-  if (command.empty()) return;
-
-  controller(primary).rumble(".");
-  printControllerScreen(command.c_str());
-
-  // Parse command
-  size_t spacePos = command.find(' ');
-  std::string cmd = command.substr(0, spacePos);
-  std::string params = spacePos != std::string::npos ? command.substr(spacePos + 1) : "";
-
-  // Execute command
-  if (cmd == "drive") {
-    chassis.driveDistance(atof(params.c_str()), 6);
-  } else if (cmd == "turn") {
-    chassis.turnToHeading(atof(params.c_str()), 6);
-  } else if (cmd == "set_heading") {
-    chassis.setHeading(atof(params.c_str()));
-  }
-  
-  chassis.stop(coast);
-}
+// Reads remote commands from the serial port on a background task.
+CommandReader commandReader(&chassis);
+// Streams the robot state to the web dashboard.
+TelemetryStream telemetryStream(&chassis);
 
 int main() {
   // Register the autonomous and driver control functions.
@@ -58,10 +23,14 @@ int main() {
   // Set up button mapping
   setupButtonMapping();
 
+  // comment out the following line to disable remote command processing
+  commandReader.setScripts(&scripts);
+  commandReader.start();
+  // comment out the following line to stop streaming telemetry to the web dashboard
+  telemetryStream.start();
+
   // Prevent main from exiting with an infinite loop.
   while (true) {
-    // comment out the following line to disable remote command processing
-    pollCommandMessages();
     wait(200, msec);
   }
 }
@@ -15,32 +15,62 @@ PID::PID(float kp, float ki, float kd, float starti, float settleError, float se
 {};
 
 float PID::update(float error){
+  return update(error, PID_TICK_MS);
+}
+
+float PID::update(float error, float dt){
+  if (dt <= 0) dt = PID_TICK_MS;
+  // The gains are tuned per PID_TICK_MS tick, so scale the I and D terms by the measured dt.
+  float ticks = dt / PID_TICK_MS;
   if (fabs(error) < starti){ // starti is used to prevent integral windup.
-    sumError+=error;
+    sumError+=error*ticks;
   }
   if ((error>0 && previousError<0)||(error<0 && previousError>0)){ 
     sumError = 0; 
   } // Eliminates the integral term if the error crosses zero.
 
-  float output = kp*error + ki*sumError + kd*(error-previousError);
+  pTerm = kp*error;
+  iTerm = ki*sumError;
+  dTerm = kd*(error-previousError)/ticks;
+  float output = pTerm + iTerm + dTerm;
   previousError=error;
 
   if(fabs(error)<settleError){
-    timeSettleTime+=10;
+    timeSettleTime+=dt;
   } else {
     timeSettleTime = 0;
   }
-  timeTimout+=10;
+  timeTimout+=dt;
 
   return output;
 }
 
+void PID::setPreviousError(float error){
+  previousError = error;
+}
+
 bool PID::isDone(){
-  if (timeTimout > timeout && timeout != 0){
+  if (isTimedOut()){
     return true;
   } 
   if (timeSettleTime > settleTime){
     return true;
   }
   return false;
-}
\ No newline at end of file
+}
+
+bool PID::isTimedOut(){
+  return timeTimout > timeout && timeout != 0;
+}
+
+float PID::getPTerm(){
+  return pTerm;
+}
+
+float PID::getITerm(){
+  return iTerm;
+}
+
+float PID::getDTerm(){
+  return dTerm;
+}
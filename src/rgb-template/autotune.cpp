@@ -0,0 +1,178 @@
+#include "vex.h"
+
+// Tuning rules as {kp / Ku, Ti / Tu, Td / Tu}, from the gentlest to the most aggressive:
+// Ziegler-Nichols no overshoot, Ziegler-Nichols some overshoot, classic Ziegler-Nichols and Pessen integral.
+static const float tuningRules[][3] = {
+  {0.2, 0.5, 0.33},
+  {0.33, 0.5, 0.33},
+  {0.6, 0.5, 0.125},
+  {0.7, 0.4, 0.15}
+};
+static const int tuningRuleCount = sizeof(tuningRules) / sizeof(tuningRules[0]);
+
+// The relay test skips this many cycles while the oscillation builds up, then averages over the next ones.
+static const int relaySkipCycles = 2;
+static const int relayMeasureCycles = 4;
+// The relay test gives up if the robot has not oscillated steadily after this many ms.
+static const float relayTimeout = 10000;
+
+AutotuneResult Drive::autotuneTurn(float maxOvershoot) {
+  return autotune(true, maxOvershoot);
+}
+
+AutotuneResult Drive::autotuneDrive(float maxOvershoot) {
+  return autotune(false, maxOvershoot);
+}
+
+AutotuneResult Drive::autotune(bool turning, float maxOvershoot) {
+  AutotuneResult result = {};
+  // Keep the current constants to put back if no candidate passes.
+  float oldKp = turning ? turnKp : driveKp;
+  float oldKi = turning ? turnKi : driveKi;
+  float oldKd = turning ? turnKd : driveKd;
+  float oldStarti = turning ? turnStarti : driveStarti;
+  // The candidates are tried as the PID constants, so the gain schedules must not replace them.
+  bool oldGainScheduling = gainScheduling;
+  gainScheduling = false;
+
+  // Half of the max voltage moves the robot well without saturating the motors.
+  float relayVoltage = (turning ? turnMaxVoltage : driveMaxVoltage) / 2;
+  // The hysteresis keeps sensor noise from switching the relay.
+  float hysteresis = turning ? 1 : 0.25;
+  float amplitude = 0;
+  if (!relayTest(turning, relayVoltage, hysteresis, result, amplitude)) {
+    gainScheduling = oldGainScheduling;
+    return result;
+  }
+
+  float step = turning ? 90 : 24;
+  // The integral only helps close to the target, a few oscillation amplitudes away.
+  float starti = threshold(3 * amplitude, 2, 15);
+  float bestDuration = 0;
+  for (int i = 0; i < tuningRuleCount && !drivetrainNeedsStopped; i++) {
+    // The PID constants are per PID_TICK_MS tick, so convert the integral and derivative times.
+    float kp = tuningRules[i][0] * result.ultimateGain;
+    float ki = kp * PID_TICK_MS / (tuningRules[i][1] * result.ultimatePeriod);
+    float kd = kp * tuningRules[i][2] * result.ultimatePeriod / PID_TICK_MS;
+    if (turning) {
+      setTurnPID(kp, ki, kd, starti);
+    } else {
+      setDrivePID(kp, ki, kd, starti);
+    }
+
+    // Step both ways so the robot ends up where it started.
+    float forwardDuration, forwardOvershoot, backwardDuration, backwardOvershoot;
+    bool forwardSettled, backwardSettled;
+    stepTest(turning, step, forwardDuration, forwardOvershoot, forwardSettled);
+    stepTest(turning, -step, backwardDuration, backwardOvershoot, backwardSettled);
+    float duration = (forwardDuration + backwardDuration) / 2;
+    float overshoot = fmax(forwardOvershoot, backwardOvershoot);
+    result.candidates++;
+
+    if (!forwardSettled || !backwardSettled || overshoot > maxOvershoot) continue;
+    result.passed++;
+    if (result.passed == 1 || duration < bestDuration) {
+      bestDuration = duration;
+      result.kp = kp;
+      result.ki = ki;
+      result.kd = kd;
+      result.starti = starti;
+      result.settleTime = duration;
+      result.overshoot = overshoot;
+    }
+  }
+
+  result.success = result.passed > 0;
+  if (!result.success) {
+    result.kp = oldKp;
+    result.ki = oldKi;
+    result.kd = oldKd;
+    result.starti = oldStarti;
+  }
+  if (turning) {
+    setTurnPID(result.kp, result.ki, result.kd, result.starti);
+  } else {
+    setDrivePID(result.kp, result.ki, result.kd, result.starti);
+  }
+  gainScheduling = oldGainScheduling;
+  return result;
+}
+
+bool Drive::relayTest(bool turning, float relayVoltage, float hysteresis, AutotuneResult& result, float& amplitude) {
+  beginMotion();
+  float start = turning ? getHeading() : (getLeftPosition() + getRightPosition()) / 2.0;
+  float output = relayVoltage;
+  float elapsed = 0, lastSwitch = 0;
+  // The highest and lowest error since the relay last switched to positive.
+  float high = 0, low = 0;
+  float periodSum = 0, amplitudeSum = 0;
+  int cycles = 0;
+  controlLoop.start();
+  while (cycles < relaySkipCycles + relayMeasureCycles && elapsed < relayTimeout && !drivetrainNeedsStopped && !motionCancelled) {
+    float error;
+    if (turning) {
+      error = normalize180(getHeading() - start);
+    } else {
+      error = (getLeftPosition() + getRightPosition()) / 2.0 - start;
+    }
+    high = fmax(high, error);
+    low = fmin(low, error);
+
+    if (output > 0 && error > hysteresis) {
+      output = -relayVoltage;
+    } else if (output < 0 && error < -hysteresis) {
+      // Each switch back to positive ends one full cycle.
+      output = relayVoltage;
+      cycles++;
+      if (cycles > relaySkipCycles) {
+        periodSum += elapsed - lastSwitch;
+        amplitudeSum += (high - low) / 2;
+      }
+      lastSwitch = elapsed;
+      high = error;
+      low = error;
+    }
+
+    if (turning) {
+      driveWithVoltage(output, -output);
+    } else {
+      driveWithVoltage(output, output);
+    }
+    elapsed += controlLoop.waitForNextTick();
+  }
+  brakeAfterMotion();
+  motionRunning = false;
+  wait(500, msec);
+
+  if (cycles < relaySkipCycles + relayMeasureCycles) return false;
+  amplitude = amplitudeSum / relayMeasureCycles;
+  if (amplitude <= 0) return false;
+  // Describing function of an ideal relay: Ku = 4d / (pi * a).
+  result.ultimateGain = 4 * relayVoltage / (M_PI * amplitude);
+  result.ultimatePeriod = periodSum / relayMeasureCycles;
+  return true;
+}
+
+void Drive::stepTest(bool turning, float step, float& duration, float& overshoot, bool& settled) {
+  float start = getHeading();
+  uint32_t startTime = timer::system();
+  MotionHandle motion = turning ? turnToHeadingAsync(start + step) : driveDistanceAsync(step, driveMaxVoltage, start, headingMaxVoltage);
+  overshoot = 0;
+  while (motion.isRunning()) {
+    // How far the robot is past the target, in the direction of the step.
+    float past;
+    if (turning) {
+      past = normalize180(getHeading() - (start + step));
+    } else {
+      past = getMotionTraveled() - step;
+    }
+    if (step < 0) past = -past;
+    overshoot = fmax(overshoot, past);
+    wait(5, msec);
+  }
+  duration = timer::system() - startTime;
+  // The motion knows why it ended; the measured duration is off by the polling above.
+  settled = motionTimer.getLastExit() == MOTION_SETTLED;
+  // Let the robot come to rest before the next step.
+  wait(500, msec);
+}
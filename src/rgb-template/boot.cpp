@@ -0,0 +1,115 @@
+#include "vex.h"
+
+BootPipeline boot;
+
+static const char* stateName(BootState state) {
+  switch (state) {
+  case BOOT_WAITING: return "waiting";
+  case BOOT_RUNNING: return "running";
+  case BOOT_DONE: return "ok";
+  case BOOT_FAILED: return "failed";
+  default: return "skipped";
+  }
+}
+
+uint32_t BootPipeline::addStage(const char* name, bool (*function)(), uint32_t dependencies) {
+  // Stages cannot be added to a running boot, or past the last one.
+  if (started || stageCount >= MAX_STAGES) return 0;
+  BootStage& stage = stages[stageCount];
+  stage.name = name;
+  stage.function = function;
+  stage.dependencies = dependencies;
+  stage.state = BOOT_WAITING;
+  stage.startTime = 0;
+  stage.endTime = 0;
+  stage.pipeline = this;
+  return 1 << stageCount++;
+}
+
+void BootPipeline::start() {
+  if (started) return;
+  started = true;
+  bootStart = timer::system();
+  for (int i = 0; i < stageCount; i++) {
+    thread stageThread = thread(stageTask, &stages[i]);
+  }
+}
+
+int BootPipeline::stageTask(void* stage) {
+  BootStage* self = (BootStage*)stage;
+  BootPipeline* pipeline = self->pipeline;
+  bool ready = pipeline->waitFor(self->dependencies);
+  self->startTime = timer::system() - pipeline->bootStart;
+  if (ready) {
+    self->state = BOOT_RUNNING;
+    bool success = self->function();
+    self->endTime = timer::system() - pipeline->bootStart;
+    self->state = success ? BOOT_DONE : BOOT_FAILED;
+  } else {
+    self->endTime = self->startTime;
+    self->state = BOOT_SKIPPED;
+  }
+  // The last stage to end records the boot time.
+  if (pipeline->isFinished() && pipeline->bootTime == 0) {
+    pipeline->bootTime = timer::system() - pipeline->bootStart;
+  }
+  return 0;
+}
+
+bool BootPipeline::hasEnded(uint32_t mask) {
+  for (int i = 0; i < stageCount; i++) {
+    if (!(mask & (1 << i))) continue;
+    if (stages[i].state == BOOT_WAITING || stages[i].state == BOOT_RUNNING) return false;
+  }
+  return true;
+}
+
+bool BootPipeline::waitFor(uint32_t mask) {
+  // Nothing to wait for if the boot never started, e.g. in the simulator.
+  if (!started) return false;
+  while (!hasEnded(mask)) {
+    wait(10, msec);
+  }
+  for (int i = 0; i < stageCount; i++) {
+    if ((mask & (1 << i)) && stages[i].state != BOOT_DONE) return false;
+  }
+  return true;
+}
+
+bool BootPipeline::waitForAll() {
+  return waitFor((1 << stageCount) - 1);
+}
+
+bool BootPipeline::isFinished() {
+  return started && hasEnded((1 << stageCount) - 1);
+}
+
+void BootPipeline::report() {
+  // List the stages in the order they started.
+  int order[MAX_STAGES];
+  for (int i = 0; i < stageCount; i++) order[i] = i;
+  for (int i = 1; i < stageCount; i++) {
+    for (int j = i; j > 0 && stages[order[j]].startTime < stages[order[j - 1]].startTime; j--) {
+      int t = order[j]; order[j] = order[j - 1]; order[j - 1] = t;
+    }
+  }
+
+  printf("boot %lu ms\n", (unsigned long)bootTime);
+  for (int i = 0; i < stageCount; i++) {
+    BootStage& stage = stages[order[i]];
+    printf("  %-12s %5lu - %5lu ms  %5lu ms  %s\n", stage.name, (unsigned long)stage.startTime, (unsigned long)stage.endTime,
+           (unsigned long)(stage.endTime - stage.startTime), stateName(stage.state));
+  }
+}
+
+int BootPipeline::getCount() {
+  return stageCount;
+}
+
+BootStage BootPipeline::getStage(int index) {
+  return stages[index];
+}
+
+uint32_t BootPipeline::getBootTime() {
+  return bootTime;
+}
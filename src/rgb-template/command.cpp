@@ -0,0 +1,404 @@
+#include "vex.h"
+
+// Serial port 1 is the user port the VEX extension and the remote control app talk to.
+static const uint32_t SERIAL_CHANNEL = 1;
+
+bool sendFrame(uint8_t type, uint8_t sequence, const uint8_t* payload, int length) {
+  if (vexSerialWriteFree(SERIAL_CHANNEL) < length + 5) return false;
+  uint8_t buffer[FRAME_MAX_PAYLOAD + 5];
+  buffer[0] = FRAME_START;
+  buffer[1] = type;
+  buffer[2] = sequence;
+  buffer[3] = length;
+  if (length > 0) {
+    memcpy(buffer + 4, payload, length);
+  }
+  uint8_t sum = 0;
+  for (int i = 1; i < length + 4; i++) {
+    sum += buffer[i];
+  }
+  buffer[length + 4] = sum;
+  vexSerialWriteBuffer(SERIAL_CHANNEL, buffer, length + 5);
+  return true;
+}
+
+CommandReader::CommandReader(Drive* drive) :
+  drive(drive),
+  tuner(drive) {}
+
+void CommandReader::setScripts(AutonScripts* scripts) {
+  this -> scripts = scripts;
+}
+
+void CommandReader::start() {
+  thread readerThread = thread(readerTask, this);
+  thread executorThread = thread(executorTask, this);
+}
+
+int CommandReader::readerTask(void* reader) {
+  CommandReader* self = (CommandReader*)reader;
+  while (true) {
+    // Take everything that has arrived, then give the other tasks a turn.
+    int32_t c;
+    while ((c = vexSerialReadChar(SERIAL_CHANNEL)) >= 0) {
+      self->receive(c);
+    }
+    // A host that lost the "end" line must not leave the text commands locked out.
+    if (self->scriptNumber > 0 && timer::system() - self->scriptLineTime > SCRIPT_TIMEOUT) {
+      self->abortScript("timed out");
+    }
+    wait(5, msec);
+  }
+  return 0;
+}
+
+void CommandReader::receive(uint8_t c) {
+  if (frameLength >= 0) {
+    frame[frameLength++] = c;
+    // The header is type, sequence and payload length; the checksum follows the payload.
+    if (frameLength >= 3) {
+      int payloadLength = frame[2];
+      if (payloadLength > FRAME_MAX_PAYLOAD) {
+        // Not a real frame, wait for the next start byte.
+        frameLength = -1;
+      } else if (frameLength == payloadLength + 4) {
+        handleFrame();
+        frameLength = -1;
+      }
+    }
+    return;
+  }
+
+  if (c == FRAME_START) {
+    frameLength = 0;
+    lineLength = 0;
+  } else if (c == '\n' || c == '\r') {
+    if (lineLength > 0) {
+      line[lineLength] = '\0';
+      handleLine();
+    }
+    lineLength = 0;
+  } else if (lineLength < (int)sizeof(line) - 1) {
+    line[lineLength++] = c;
+  }
+}
+
+void CommandReader::handleFrame() {
+  Command command;
+  command.type = frame[0];
+  command.sequence = frame[1];
+  command.framed = true;
+  command.value = 0;
+  command.maxVoltage = 0;
+  int payloadLength = frame[2];
+
+  uint8_t sum = 0;
+  for (int i = 0; i < payloadLength + 3; i++) {
+    sum += frame[i];
+  }
+  if (sum != frame[payloadLength + 3]) {
+    uint8_t reason = COMMAND_ERROR_CHECKSUM;
+    sendFrame(REPLY_NAK, command.sequence, &reason, 1);
+    return;
+  }
+
+  // Motions take a value and an optional max voltage.
+  bool motion = command.type == COMMAND_DRIVE || command.type == COMMAND_TURN ||
+                command.type == COMMAND_TUNE_DRIVE || command.type == COMMAND_TUNE_TURN;
+  bool hasValue = motion || command.type == COMMAND_SET_HEADING;
+  bool noValue = command.type == COMMAND_STOP || command.type == COMMAND_STATUS;
+  bool lengthValid = motion ? payloadLength == sizeof(float) || payloadLength == 2 * sizeof(float) :
+                     hasValue ? payloadLength == sizeof(float) : payloadLength == 0;
+  if (!lengthValid || (!hasValue && !noValue)) {
+    uint8_t reason = COMMAND_ERROR_UNKNOWN;
+    sendFrame(REPLY_NAK, command.sequence, &reason, 1);
+    return;
+  }
+  if (hasValue) {
+    memcpy(&command.value, frame + 3, sizeof(float));
+  }
+  if (payloadLength == 2 * sizeof(float)) {
+    memcpy(&command.maxVoltage, frame + 3 + sizeof(float), sizeof(float));
+  }
+  accept(command);
+}
+
+void CommandReader::handleScriptLine() {
+  scriptLineTime = timer::system();
+  if (strcmp(line, "end") != 0) {
+    int length = strlen(line);
+    // Keep reading to "end" after an overflow, so the rest of the script is not taken as commands.
+    if (scriptLength >= 0 && scriptLength + length + 1 <= SCRIPT_SIZE) {
+      memcpy(scriptText + scriptLength, line, length);
+      scriptText[scriptLength + length] = '\n';
+      scriptLength += length + 1;
+    } else {
+      scriptLength = -1;
+      printf("error script larger than %d bytes, skipping to end\n", SCRIPT_SIZE);
+    }
+    return;
+  }
+
+  int number = scriptNumber;
+  scriptNumber = 0;
+  if (scriptLength < 0) {
+    printf("error script larger than %d bytes\n", SCRIPT_SIZE);
+    return;
+  }
+  scriptText[scriptLength] = '\0';
+  char error[48];
+  int steps = scripts->save(number, scriptText, error);
+  if (steps < 0) {
+    printf("error %s\n", error);
+    return;
+  }
+  printf("ok script %d steps %d\n", number, steps);
+}
+
+void CommandReader::abortScript(const char* reason) {
+  printf("error script %d upload %s\n", scriptNumber, reason);
+  scriptNumber = 0;
+}
+
+void CommandReader::handleConfigLine(bool set) {
+  char parameter[24];
+  float value;
+  int count = sscanf(line, "%*s %23s %f", parameter, &value);
+  if (count < (set ? 2 : 1)) {
+    printf(set ? "error set needs a name and a value\n" : "error get needs a name\n");
+    return;
+  }
+  // A change takes effect right away; "save" keeps it across restarts.
+  float current;
+  if (!configStore.get(parameter, current)) {
+    printf("error unknown parameter: %s\n", parameter);
+    return;
+  }
+  if (set && !configStore.set(parameter, value)) {
+    printf("error %s cannot be %g\n", parameter, value);
+    return;
+  }
+  if (!set) value = current;
+  printf("ok %s %g\n", parameter, value);
+}
+
+void CommandReader::handleLine() {
+  // stop and status still work during an upload; stop and abort end it.
+  if (scriptNumber > 0) {
+    if (strcmp(line, "abort") == 0) {
+      abortScript("aborted");
+      return;
+    }
+    if (strcmp(line, "stop") == 0) {
+      abortScript("aborted by stop");
+    } else if (strcmp(line, "status") != 0) {
+      handleScriptLine();
+      return;
+    }
+  }
+
+  char name[16];
+  Command command;
+  command.sequence = 0;
+  command.framed = false;
+  command.value = 0;
+  command.maxVoltage = 0;
+  if (sscanf(line, "%15s %f %f", name, &command.value, &command.maxVoltage) < 1) return;
+
+  if (strcmp(name, "script") == 0 || strcmp(name, "reload") == 0) {
+    if (!scripts) {
+      printf("error no scripts\n");
+    } else if (name[0] == 'r') {
+      printf("ok reload %d scripts\n", scripts->load());
+    } else if (command.value < 1) {
+      printf("error script number\n");
+    } else {
+      scriptNumber = command.value;
+      scriptLength = 0;
+      scriptLineTime = timer::system();
+    }
+    return;
+  }
+
+  if (strcmp(name, "set") == 0 || strcmp(name, "get") == 0) {
+    handleConfigLine(name[0] == 's');
+    return;
+  }
+  if (strcmp(name, "config") == 0) {
+    configStore.print();
+    return;
+  }
+  if (strcmp(name, "save") == 0) {
+    printf(configStore.save() ? "ok save\n" : "error cannot write the config\n");
+    return;
+  }
+  if (strcmp(name, "load") == 0) {
+    printf(configStore.load() ? "ok load\n" : "error no saved config\n");
+    return;
+  }
+
+  if (strcmp(name, "tune") == 0) {
+    char move[8];
+    if (sscanf(line, "%*s %7s %f %f", move, &command.value, &command.maxVoltage) < 2 ||
+        (strcmp(move, "turn") != 0 && strcmp(move, "drive") != 0)) {
+      printf("error tune needs turn or drive and a distance\n");
+      return;
+    }
+    command.type = move[0] == 't' ? COMMAND_TUNE_TURN : COMMAND_TUNE_DRIVE;
+  } else if (strcmp(name, "drive") == 0) {
+    command.type = COMMAND_DRIVE;
+  } else if (strcmp(name, "turn") == 0) {
+    command.type = COMMAND_TURN;
+  } else if (strcmp(name, "set_heading") == 0) {
+    command.type = COMMAND_SET_HEADING;
+  } else if (strcmp(name, "stop") == 0) {
+    command.type = COMMAND_STOP;
+  } else if (strcmp(name, "status") == 0) {
+    command.type = COMMAND_STATUS;
+  } else {
+    printf("error unknown command: %s\n", name);
+    return;
+  }
+  accept(command);
+}
+
+void CommandReader::accept(Command command) {
+  if (command.type == COMMAND_STATUS) {
+    sendStatus(command);
+    return;
+  }
+
+  if (command.type == COMMAND_STOP) {
+    // Clear the queue first so the executor does not start the next command.
+    queueLock.lock();
+    queueCount = 0;
+    queueLock.unlock();
+    drive->stop(coast);
+  } else {
+    queueLock.lock();
+    bool full = queueCount == QUEUE_SIZE;
+    if (!full) {
+      queue[(queueHead + queueCount) % QUEUE_SIZE] = command;
+      queueCount++;
+    }
+    queueLock.unlock();
+    if (full) {
+      if (command.framed) {
+        uint8_t reason = COMMAND_ERROR_QUEUE_FULL;
+        sendFrame(REPLY_NAK, command.sequence, &reason, 1);
+      } else {
+        printf("error queue full\n");
+      }
+      return;
+    }
+  }
+
+  if (command.framed) {
+    uint8_t length = getQueueLength();
+    sendFrame(REPLY_ACK, command.sequence, &length, 1);
+  } else {
+    printf("ok %s\n", line);
+  }
+}
+
+bool CommandReader::takeCommand(Command& command) {
+  queueLock.lock();
+  bool found = queueCount > 0;
+  if (found) {
+    command = queue[queueHead];
+    queueHead = (queueHead + 1) % QUEUE_SIZE;
+    queueCount--;
+  }
+  queueLock.unlock();
+  return found;
+}
+
+int CommandReader::getQueueLength() {
+  return queueCount;
+}
+
+int CommandReader::executorTask(void* reader) {
+  CommandReader* self = (CommandReader*)reader;
+  Command command;
+  while (true) {
+    if (!self->takeCommand(command)) {
+      wait(10, msec);
+      continue;
+    }
+
+    char message[30];
+    if (command.type == COMMAND_DRIVE) {
+      sprintf(message, "drive %.1f", command.value);
+    } else if (command.type == COMMAND_TURN) {
+      sprintf(message, "turn %.1f", command.value);
+    } else if (command.type == COMMAND_TUNE_DRIVE || command.type == COMMAND_TUNE_TURN) {
+      sprintf(message, "tune %s %.1f", command.type == COMMAND_TUNE_TURN ? "turn" : "drive", command.value);
+    } else {
+      sprintf(message, "set_heading %.1f", command.value);
+    }
+    self->executing = true;
+    display.rumble(".");
+    printControllerScreen(message);
+
+    float maxVoltage = command.maxVoltage > 0 ? command.maxVoltage : MOTION_MAX_VOLTAGE;
+    if (command.type == COMMAND_DRIVE) {
+      self->drive->driveDistance(command.value, maxVoltage);
+    } else if (command.type == COMMAND_TURN) {
+      self->drive->turnToHeading(command.value, maxVoltage);
+    } else if (command.type == COMMAND_TUNE_DRIVE || command.type == COMMAND_TUNE_TURN) {
+      self->runTuning(command);
+    } else {
+      self->drive->setHeading(command.value);
+    }
+    // Let the robot coast once the queue runs dry, like a driver letting go of the sticks.
+    if (self->getQueueLength() == 0) {
+      self->drive->stop(coast);
+    }
+    self->executing = false;
+
+    if (command.framed) {
+      sendFrame(REPLY_DONE, command.sequence, nullptr, 0);
+    } else {
+      printf("done %s\n", message);
+    }
+  }
+  return 0;
+}
+
+void CommandReader::runTuning(Command command) {
+  // The test moves run at the chassis maximum voltage unless the command sets one,
+  // so the constants are tuned for the speed the autons use.
+  MotionTiming results[2];
+  bool turning = command.type == COMMAND_TUNE_TURN;
+  tuner.run(turning, command.value, command.maxVoltage, !command.framed, results);
+  for (int i = 0; i < 2; i++) {
+    MotionTiming& result = results[i];
+    if (!command.framed) {
+      printf("result %d time %.0f firstband %.0f overshoot %.2f %s\n", i + 1, result.totalTime, result.firstBandTime, result.overshoot,
+             result.exit == MOTION_SETTLED ? "settled" : result.exit == MOTION_TIMED_OUT ? "timeout" : "cancelled");
+      continue;
+    }
+    uint8_t payload[2 + 3 * sizeof(float)];
+    payload[0] = i + 1;
+    payload[1] = result.exit;
+    memcpy(payload + 2, &result.totalTime, sizeof(float));
+    memcpy(payload + 6, &result.firstBandTime, sizeof(float));
+    memcpy(payload + 10, &result.overshoot, sizeof(float));
+    sendFrame(REPLY_TUNE, command.sequence, payload, sizeof(payload));
+  }
+}
+
+void CommandReader::sendStatus(Command command) {
+  Pose pose = drive->getPose();
+  if (!command.framed) {
+    printf("status x %.1f y %.1f heading %.1f running %d queue %d\n", pose.x, pose.y, pose.heading, executing, getQueueLength());
+    return;
+  }
+  uint8_t payload[3 * sizeof(float) + 2];
+  memcpy(payload, &pose.x, sizeof(float));
+  memcpy(payload + 4, &pose.y, sizeof(float));
+  memcpy(payload + 8, &pose.heading, sizeof(float));
+  payload[12] = executing;
+  payload[13] = getQueueLength();
+  sendFrame(REPLY_STATUS, command.sequence, payload, sizeof(payload));
+}
@@ -0,0 +1,233 @@
+#include "vex.h"
+#include <stddef.h>
+
+ConfigStore configStore;
+
+// The names of the parameters and where they are in RobotConfig.
+struct ConfigParameter
+{
+  const char* name;
+  int offset;
+  bool integer;
+  // The allowed values of an integer parameter; any value if both are 0.
+  int32_t min, max;
+};
+
+static const ConfigParameter PARAMETERS[] = {
+  {"turn_max_voltage", offsetof(RobotConfig, turnMaxVoltage), false},
+  {"drive_max_voltage", offsetof(RobotConfig, driveMaxVoltage), false},
+  {"heading_max_voltage", offsetof(RobotConfig, headingMaxVoltage), false},
+  {"drive_kp", offsetof(RobotConfig, driveKp), false},
+  {"drive_ki", offsetof(RobotConfig, driveKi), false},
+  {"drive_kd", offsetof(RobotConfig, driveKd), false},
+  {"drive_starti", offsetof(RobotConfig, driveStarti), false},
+  {"turn_kp", offsetof(RobotConfig, turnKp), false},
+  {"turn_ki", offsetof(RobotConfig, turnKi), false},
+  {"turn_kd", offsetof(RobotConfig, turnKd), false},
+  {"turn_starti", offsetof(RobotConfig, turnStarti), false},
+  {"heading_kp", offsetof(RobotConfig, headingKp), false},
+  {"heading_kd", offsetof(RobotConfig, headingKd), false},
+  {"max_velocity", offsetof(RobotConfig, maxVelocity), false},
+  {"max_acceleration", offsetof(RobotConfig, maxAcceleration), false},
+  {"max_jerk", offsetof(RobotConfig, maxJerk), false},
+  {"kv", offsetof(RobotConfig, kV), false},
+  {"ka", offsetof(RobotConfig, kA), false},
+  {"ks", offsetof(RobotConfig, kS), false},
+  {"drive_settle_error", offsetof(RobotConfig, driveSettleError), false},
+  {"drive_settle_time", offsetof(RobotConfig, driveSettleTime), false},
+  {"drive_timeout", offsetof(RobotConfig, driveTimeout), false},
+  {"turn_settle_error", offsetof(RobotConfig, turnSettleError), false},
+  {"turn_settle_time", offsetof(RobotConfig, turnSettleTime), false},
+  {"turn_timeout", offsetof(RobotConfig, turnTimeout), false},
+  {"chain_drive_error", offsetof(RobotConfig, chainDriveError), false},
+  {"chain_turn_error", offsetof(RobotConfig, chainTurnError), false},
+  {"k_brake", offsetof(RobotConfig, kBrake), false},
+  {"k_turn_bias", offsetof(RobotConfig, kTurnBias), false},
+  {"k_turn_damping", offsetof(RobotConfig, kTurnDampingFactor), false},
+  // usercontrol() only has the drive modes 0 to 3; any other leaves the robot undrivable.
+  {"drive_mode", offsetof(RobotConfig, driveMode), true, 0, 3},
+  {"auton", offsetof(RobotConfig, autonSelection), true},
+  {"gain_scheduling", offsetof(RobotConfig, gainScheduling), true, 0, 1}
+};
+static const int PARAMETER_COUNT = sizeof(PARAMETERS) / sizeof(PARAMETERS[0]);
+
+// The header of a config file. The config follows it, then the CRC of the header and the config.
+struct ConfigHeader
+{
+  uint32_t magic;
+  uint16_t version;
+  // The size of the config in the file, in bytes.
+  uint16_t size;
+  uint32_t sequence;
+};
+
+static const char* const SLOT_NAMES[2] = {"config_a.bin", "config_b.bin"};
+
+// The CRC-32 used by zip and PNG, bit by bit: the file is too small to need a table.
+static uint32_t crc32(const uint8_t* data, int length) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (int i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+// Returns true if a value is allowed for a parameter.
+static bool inRange(const ConfigParameter& parameter, float value) {
+  if (!parameter.integer || (parameter.min == 0 && parameter.max == 0)) return true;
+  return value >= parameter.min && value <= parameter.max;
+}
+
+void ConfigStore::setDefaults(const RobotConfig& defaults) {
+  lock.lock();
+  config = defaults;
+  this -> defaults = defaults;
+  lock.unlock();
+}
+
+void ConfigStore::setApply(void (*apply)()) {
+  this -> apply = apply;
+}
+
+bool ConfigStore::readSlot(int slot, RobotConfig& config, uint32_t& sequence) {
+  if (!Brain.SDcard.exists(SLOT_NAMES[slot])) return false;
+  uint8_t buffer[sizeof(ConfigHeader) + sizeof(RobotConfig) + sizeof(uint32_t)];
+  int length = Brain.SDcard.loadfile(SLOT_NAMES[slot], buffer, sizeof(buffer));
+  if (length < (int)(sizeof(ConfigHeader) + sizeof(uint32_t))) return false;
+
+  ConfigHeader header;
+  memcpy(&header, buffer, sizeof(header));
+  if (header.magic != MAGIC || header.version > VERSION || header.size > sizeof(RobotConfig)) return false;
+  int dataLength = sizeof(ConfigHeader) + header.size;
+  if (length != dataLength + (int)sizeof(uint32_t)) return false;
+  uint32_t crc;
+  memcpy(&crc, buffer + dataLength, sizeof(crc));
+  if (crc != crc32(buffer, dataLength)) return false;
+
+  // An older file is shorter: its fields go over the defaults, the rest keep theirs.
+  memcpy(&config, buffer + sizeof(ConfigHeader), header.size);
+  sequence = header.sequence;
+  return true;
+}
+
+bool ConfigStore::load() {
+  int newest = -1;
+  if (Brain.SDcard.isInserted()) {
+    lock.lock();
+    RobotConfig slotConfig[2] = {config, config};
+    uint32_t slotSequence[2] = {0, 0};
+    bool valid[2];
+    for (int i = 0; i < 2; i++) {
+      valid[i] = readSlot(i, slotConfig[i], slotSequence[i]);
+    }
+    // The newest whole slot wins. The sequence numbers are compared as a difference, so they can wrap.
+    if (valid[0] && valid[1]) {
+      newest = (int32_t)(slotSequence[1] - slotSequence[0]) > 0 ? 1 : 0;
+    } else if (valid[0] || valid[1]) {
+      newest = valid[0] ? 0 : 1;
+    }
+    if (newest >= 0) {
+      config = slotConfig[newest];
+      sequence = slotSequence[newest];
+      slot = newest;
+      // A value that is not allowed, e.g. from an older program, goes back to the default.
+      for (int i = 0; i < PARAMETER_COUNT; i++) {
+        int32_t* field = (int32_t*)((uint8_t*)&config + PARAMETERS[i].offset);
+        if (PARAMETERS[i].integer && !inRange(PARAMETERS[i], *field)) {
+          printf("config: %s %d is not allowed, using the default\n", PARAMETERS[i].name, (int)*field);
+          *field = *(int32_t*)((uint8_t*)&defaults + PARAMETERS[i].offset);
+        }
+      }
+    }
+    lock.unlock();
+  }
+  if (newest < 0) printf("config: no saved config, using the defaults\n");
+  if (apply) apply();
+  return newest >= 0;
+}
+
+bool ConfigStore::save() {
+  if (!Brain.SDcard.isInserted()) return false;
+  lock.lock();
+  uint8_t buffer[sizeof(ConfigHeader) + sizeof(RobotConfig) + sizeof(uint32_t)];
+  ConfigHeader header;
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.size = sizeof(RobotConfig);
+  header.sequence = sequence + 1;
+  memcpy(buffer, &header, sizeof(header));
+  memcpy(buffer + sizeof(header), &config, sizeof(config));
+  uint32_t crc = crc32(buffer, sizeof(header) + sizeof(config));
+  memcpy(buffer + sizeof(header) + sizeof(config), &crc, sizeof(crc));
+
+  // Never write over the newest slot: if this write is cut short, load() still finds it.
+  int target = slot == 0 ? 1 : 0;
+  bool success = Brain.SDcard.savefile(SLOT_NAMES[target], buffer, sizeof(buffer)) == (int)sizeof(buffer);
+  if (success) {
+    sequence = header.sequence;
+    slot = target;
+  }
+  lock.unlock();
+  return success;
+}
+
+RobotConfig ConfigStore::get() {
+  lock.lock();
+  RobotConfig copy = config;
+  lock.unlock();
+  return copy;
+}
+
+void* ConfigStore::find(const char* name, bool& integer) {
+  for (int i = 0; i < PARAMETER_COUNT; i++) {
+    if (strcmp(name, PARAMETERS[i].name) != 0) continue;
+    integer = PARAMETERS[i].integer;
+    return (uint8_t*)&config + PARAMETERS[i].offset;
+  }
+  return nullptr;
+}
+
+bool ConfigStore::isAllowed(const char* name, float value) {
+  for (int i = 0; i < PARAMETER_COUNT; i++) {
+    if (strcmp(name, PARAMETERS[i].name) == 0) return inRange(PARAMETERS[i], value);
+  }
+  return false;
+}
+
+bool ConfigStore::set(const char* name, float value) {
+  if (!isAllowed(name, value)) return false;
+  bool integer;
+  lock.lock();
+  void* field = find(name, integer);
+  if (field) {
+    if (integer) {
+      *(int32_t*)field = (int32_t)value;
+    } else {
+      *(float*)field = value;
+    }
+  }
+  lock.unlock();
+  if (!field) return false;
+  if (apply) apply();
+  return true;
+}
+
+bool ConfigStore::get(const char* name, float& value) {
+  bool integer;
+  lock.lock();
+  void* field = find(name, integer);
+  if (field) value = integer ? *(int32_t*)field : *(float*)field;
+  lock.unlock();
+  return field != nullptr;
+}
+
+void ConfigStore::print() {
+  for (int i = 0; i < PARAMETER_COUNT; i++) {
+    float value;
+    get(PARAMETERS[i].name, value);
+    printf("%s %g\n", PARAMETERS[i].name, value);
+  }
+}
@@ -0,0 +1,47 @@
+#include "vex.h"
+
+ResponseCurve::ResponseCurve() {
+  for (int i = 0; i <= 100; i++) {
+    table[i] = i;
+  }
+}
+
+ResponseCurve ResponseCurve::exponential(float curveScale) {
+  ResponseCurve curve;
+  for (int i = 0; i <= 100; i++) {
+    curve.table[i] = curveFunction(i, curveScale);
+  }
+  return curve;
+}
+
+ResponseCurve ResponseCurve::cubic(float weight) {
+  ResponseCurve curve;
+  for (int i = 0; i <= 100; i++) {
+    curve.table[i] = (1 - weight) * i + weight * i * i * i / 10000.0;
+  }
+  return curve;
+}
+
+ResponseCurve ResponseCurve::piecewise(const float* inputs, const float* outputs, int count) {
+  ResponseCurve curve;
+  int segment = 0;
+  for (int i = 0; i <= 100; i++) {
+    while (segment < count - 2 && i > inputs[segment + 1]) {
+      segment++;
+    }
+    if (count < 2 || inputs[segment + 1] <= inputs[segment]) continue;
+    float t = (i - inputs[segment]) / (inputs[segment + 1] - inputs[segment]);
+    curve.table[i] = threshold(outputs[segment] + t * (outputs[segment + 1] - outputs[segment]), 0, 100);
+  }
+  return curve;
+}
+
+float ResponseCurve::apply(float x) const {
+  float magnitude = fabs(x);
+  if (magnitude >= 100) {
+    return x > 0 ? table[100] : -table[100];
+  }
+  int i = (int)magnitude;
+  float output = table[i] + (magnitude - i) * (table[i + 1] - table[i]);
+  return x < 0 ? -output : output;
+}
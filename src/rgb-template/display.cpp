@@ -0,0 +1,184 @@
+#include "vex.h"
+#include <stdarg.h>
+
+Display display;
+
+Display::Display() {
+  for (int i = 0; i < CONTROLLER_ROWS; i++) {
+    controllerLines[i].status[0] = '\0';
+    controllerLines[i].alert[0] = '\0';
+    controllerLines[i].alertUntil = 0;
+    controllerLines[i].dirty = false;
+  }
+  rumblePattern[0] = '\0';
+  for (int i = 0; i < BRAIN_ROWS; i++) {
+    brainLines[i][0] = '\0';
+    brainDirty[i] = false;
+  }
+}
+
+void Display::start() {
+  if (running) return;
+  running = true;
+  thread displayThread = thread(displayTask, this);
+}
+
+int Display::displayTask(void* display) {
+  Display* self = (Display*)display;
+  while (true) {
+    self->flushBrain();
+    self->flushController();
+    wait(CONTROLLER_PERIOD, msec);
+  }
+  return 0;
+}
+
+void Display::printController(int row, const char* format, ...) {
+  if (row < 1 || row > CONTROLLER_ROWS) return;
+  char text[CONTROLLER_COLUMNS + 1];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+
+  ControllerLine& line = controllerLines[row - 1];
+  lock.lock();
+  if (strcmp(line.status, text) != 0) {
+    strcpy(line.status, text);
+    line.dirty = true;
+  }
+  lock.unlock();
+}
+
+void Display::alert(const char* message, const char* rumblePattern) {
+  ControllerLine& line = controllerLines[0];
+  lock.lock();
+  snprintf(line.alert, sizeof(line.alert), "%s", message);
+  line.alertUntil = timer::system() + ALERT_HOLD;
+  line.dirty = true;
+  snprintf(this->rumblePattern, sizeof(this->rumblePattern), "%s", rumblePattern);
+  lock.unlock();
+}
+
+void Display::rumble(const char* pattern) {
+  lock.lock();
+  snprintf(rumblePattern, sizeof(rumblePattern), "%s", pattern);
+  lock.unlock();
+}
+
+void Display::clearController() {
+  lock.lock();
+  for (int i = 0; i < CONTROLLER_ROWS; i++) {
+    if (controllerLines[i].status[0] != '\0') {
+      controllerLines[i].status[0] = '\0';
+      controllerLines[i].dirty = true;
+    }
+  }
+  lock.unlock();
+}
+
+void Display::flushController() {
+  uint32_t now = timer::system();
+  char text[CONTROLLER_COLUMNS + 1];
+  char pattern[8] = "";
+  int row = -1;
+
+  lock.lock();
+  for (int i = 0; i < CONTROLLER_ROWS; i++) {
+    ControllerLine& line = controllerLines[i];
+    // When an alert expires, the status text under it needs to be written again.
+    if (line.alert[0] != '\0' && now >= line.alertUntil) {
+      line.alert[0] = '\0';
+      line.dirty = true;
+    }
+    if (row < 0 && line.dirty && line.alert[0] != '\0') {
+      row = i;
+    }
+  }
+  if (row < 0 && rumblePattern[0] != '\0') {
+    strcpy(pattern, rumblePattern);
+    rumblePattern[0] = '\0';
+  }
+  // Status lines take turns, so a line that changes often cannot hold back the others.
+  for (int n = 1; row < 0 && pattern[0] == '\0' && n <= CONTROLLER_ROWS; n++) {
+    int i = (lastControllerRow + n) % CONTROLLER_ROWS;
+    if (controllerLines[i].dirty) row = i;
+  }
+  if (row >= 0) {
+    ControllerLine& line = controllerLines[row];
+    snprintf(text, sizeof(text), "%-*s", CONTROLLER_COLUMNS, line.alert[0] != '\0' ? line.alert : line.status);
+    line.dirty = false;
+    lastControllerRow = row;
+  }
+  lock.unlock();
+
+  if (row >= 0) {
+    controller1.Screen.setCursor(row + 1, 1);
+    controller1.Screen.print("%s", text);
+  } else if (pattern[0] != '\0') {
+    controller1.rumble(pattern);
+  }
+}
+
+void Display::printBrain(int row, const char* format, ...) {
+  if (row < 1 || row > BRAIN_ROWS) return;
+  char text[BRAIN_COLUMNS + 1];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+
+  lock.lock();
+  if (strcmp(brainLines[row - 1], text) != 0) {
+    strcpy(brainLines[row - 1], text);
+    brainDirty[row - 1] = true;
+  }
+  lock.unlock();
+}
+
+void Display::clearBrain() {
+  lock.lock();
+  for (int i = 0; i < BRAIN_ROWS; i++) {
+    brainLines[i][0] = '\0';
+    brainDirty[i] = false;
+  }
+  brainClearPending = true;
+  lock.unlock();
+}
+
+void Display::setBrainFont(fontType font) {
+  lock.lock();
+  brainFont = font;
+  brainFontPending = true;
+  lock.unlock();
+}
+
+void Display::flushBrain() {
+  // The brain screen is local and quick to write, so all changed lines go at once.
+  char lines[BRAIN_ROWS][BRAIN_COLUMNS + 1];
+  bool dirty[BRAIN_ROWS];
+  bool clear, setFont;
+  fontType font;
+
+  lock.lock();
+  clear = brainClearPending;
+  setFont = brainFontPending;
+  font = brainFont;
+  brainClearPending = false;
+  brainFontPending = false;
+  for (int i = 0; i < BRAIN_ROWS; i++) {
+    dirty[i] = brainDirty[i];
+    if (dirty[i]) strcpy(lines[i], brainLines[i]);
+    brainDirty[i] = false;
+  }
+  lock.unlock();
+
+  if (clear) Brain.Screen.clearScreen();
+  if (setFont) Brain.Screen.setFont(font);
+  for (int i = 0; i < BRAIN_ROWS; i++) {
+    if (!dirty[i]) continue;
+    Brain.Screen.clearLine(i + 1);
+    Brain.Screen.setCursor(i + 1, 1);
+    Brain.Screen.print("%s", lines[i]);
+  }
+}
@@ -5,7 +5,9 @@ Drive::Drive(motor_group leftDrive, motor_group rightDrive, inertial inertialSen
   rightDrive(rightDrive),
   wheelDiameter(wheelDiameter),
   gearRatio(gearRatio),
-  inertialSensor(inertialSensor) {}
+  odometryLoop(5),
+  inertialSensor(inertialSensor),
+  controlLoop(PID_TICK_MS) {}
 
 void Drive::setMaxVoltage(float turnMaxVoltage, float driveMaxVoltage, float headingMaxVoltage)
 { 
@@ -14,6 +16,10 @@ void Drive::setMaxVoltage(float turnMaxVoltage, float driveMaxVoltage, float hea
   this -> headingMaxVoltage = headingMaxVoltage;
 }
 
+void Drive::setLoopPeriod(float loopPeriod) {
+  controlLoop.setPeriod(loopPeriod);
+}
+
 void Drive::setTurnPID(float turnKp, float turnKi, float turnKd, float turnStarti) {
   this -> turnKp = turnKp;
   this -> turnKi = turnKi;
@@ -28,6 +34,18 @@ void Drive::setDrivePID(float driveKp, float driveKi, float driveKd, float drive
   this -> driveStarti = driveStarti;
 }
 
+void Drive::setDriveProfile(float maxVelocity, float maxAcceleration, float maxJerk) {
+  this -> profileMaxVelocity = maxVelocity;
+  this -> profileMaxAcceleration = maxAcceleration;
+  this -> profileMaxJerk = maxJerk;
+}
+
+void Drive::setDriveFeedforward(float kV, float kA, float kS) {
+  this -> driveKv = kV;
+  this -> driveKa = kA;
+  this -> driveKs = kS;
+}
+
 void Drive::setHeadingPID(float headingKp, float headingKd) {
   this -> headingKp = headingKp;
   this -> headingKd = headingKd;
@@ -45,15 +63,120 @@ void Drive::setDriveExitConditions(float driveSettleError, float driveSettleTime
   this -> driveTimeout = driveTimeout;
 }
 
+void Drive::setDriveSchedule(const GainSchedule& schedule) {
+  this -> driveSchedule = schedule;
+}
+
+void Drive::setTurnSchedule(const GainSchedule& schedule) {
+  this -> turnSchedule = schedule;
+}
+
+void Drive::setGainScheduling(bool enabled) {
+  this -> gainScheduling = enabled;
+}
+
+bool Drive::getGainScheduling() {
+  return gainScheduling;
+}
+
+GainPoint Drive::driveGains(float size) {
+  GainPoint gains = {size, driveKp, driveKi, driveKd, driveStarti, driveSettleError};
+  if (gainScheduling) driveSchedule.lookup(size, gains);
+  return gains;
+}
+
+GainPoint Drive::turnGains(float size) {
+  GainPoint gains = {size, turnKp, turnKi, turnKd, turnStarti, turnSettleError};
+  if (gainScheduling) turnSchedule.lookup(size, gains);
+  return gains;
+}
+
 void Drive::setHeading(float orientationDeg) {
   inertialSensor.setHeading(orientationDeg, deg);
+  headingFilter.setHeading(orientationDeg);
+  odometry.setHeading(orientationDeg);
   targetHeading = orientationDeg;
 }
 
+void Drive::startOdometry(float periodMs) {
+  odometryLoop.setPeriod(periodMs);
+  if (odometryRunning) return;
+  odometryRunning = true;
+  thread odometryThread = thread(odometryTask, this);
+}
+
+int Drive::odometryTask(void* drive) {
+  Drive* self = (Drive*)drive;
+  self->odometryLoop.run(odometryTick, drive);
+  return 0;
+}
+
+bool Drive::odometryTick(float dt, void* drive) {
+  Drive* self = (Drive*)drive;
+  float left = self->getLeftPosition(), right = self->getRightPosition();
+  self->headingFilter.update(left, right, self->inertialSensor.rotation(), dt);
+  self->odometry.update(left, right, self->headingFilter.getRotation());
+  return true;
+}
+
+Pose Drive::getPose() {
+  return odometry.getPose();
+}
+
+void Drive::setPose(float x, float y, float heading) {
+  Pose pose = {x, y, heading};
+  odometry.setPose(pose);
+  setHeading(heading);
+}
+
+MotionExit Drive::motionExit(PID& pid) {
+  if (motionCancelled || drivetrainNeedsStopped) return MOTION_CANCELLED;
+  if (pid.isTimedOut()) return MOTION_TIMED_OUT;
+  return MOTION_SETTLED;
+}
+
+void Drive::resetDrivePosition() {
+  leftDrive.resetPosition();
+  rightDrive.resetPosition();
+  odometry.resetEncoders();
+  headingFilter.resetEncoders();
+}
+
+float Drive::getWheelDiameter() {
+  return wheelDiameter;
+}
+
+float Drive::getGearRatio() {
+  return gearRatio;
+}
+
+void Drive::setTrackWidth(float trackWidth) {
+  this -> trackWidth = trackWidth;
+  headingFilter.setTrackWidth(trackWidth);
+}
+
+float Drive::getTrackWidth() {
+  return trackWidth;
+}
+
 float Drive::getHeading() {
+  // The filter runs on the odometry task.
+  if (!odometryRunning) return inertialSensor.heading();
+  return headingFilter.getHeading();
+}
+
+float Drive::getInertialHeading() {
   return inertialSensor.heading();
 }
 
+void Drive::setHeadingFusion(float timeConstant, float slipThreshold) {
+  headingFilter.setFusion(timeConstant, slipThreshold);
+}
+
+bool Drive::isWheelSlipping() {
+  return headingFilter.isSlipping();
+}
+
 float Drive::getLeftPosition() {
   return leftDrive.position(deg) / 360.0 * gearRatio  * M_PI * wheelDiameter;
 }
@@ -73,17 +196,43 @@ void Drive::turnToHeading(float heading) {
 }
 
 void Drive::turnToHeading(float heading, float turnMaxVoltage) {
+  beginMotion();
+  turnToHeadingLoop(heading, turnMaxVoltage);
+}
+
+void Drive::turnToHeadingLoop(float heading, float turnMaxVoltage) {
   targetHeading = normalize360(heading);
-  PID turnPID(turnKp, turnKi, turnKd, turnStarti, turnSettleError, turnSettleTime, turnTimeout);
-  while (!turnPID.isDone() && !drivetrainNeedsStopped) {
+  GainPoint gains = turnGains(normalize180(heading - getHeading()));
+  PID turnPID(gains.kp, gains.ki, gains.kd, gains.starti, gains.settleError, turnSettleTime, turnTimeout);
+  motionTimer.beginMotion(TELEMETRY_TURN, targetHeading, gains.settleError);
+  controlLoop.start();
+  float dt = controlLoop.getPeriod();
+  bool first = true, passed = false;
+  while (!turnPID.isDone() && !drivetrainNeedsStopped && !motionCancelled) {
+    measureVelocity(dt, first);
     float error = normalize180(heading - getHeading());
-    float output = turnPID.update(error);
+    motionHeadingError = error;
+    motionTimer.updateMotion(error, dt);
+    if (chaining && fabs(error) < chainTurnError) {
+      passed = true;
+      break;
+    }
+    if (first) carryVelocity(turnPID, error, chainTurnRate, dt);
+    first = false;
+    float output = turnPID.update(error, dt);
     output = threshold(output, -turnMaxVoltage, turnMaxVoltage);
     driveWithVoltage(output, -output);
-    wait(10, msec);
+    recordTelemetry(TELEMETRY_TURN, error, turnPID, output);
+    dt = controlLoop.waitForNextTick();
+  }
+  motionTimer.endMotion(passed ? MOTION_PASSED : motionExit(turnPID));
+  if (passed) {
+    passThrough(MOTION_TURN, 0, heading, turnMaxVoltage, 0);
+  } else {
+    brakeAfterMotion();
+    chainCarry = false;
   }
-  leftDrive.stop(hold);
-  rightDrive.stop(hold);
+  motionRunning = false;
 }
 
 void Drive::driveDistance(float distance) {
@@ -95,26 +244,573 @@ void Drive::driveDistance(float distance, float driveMaxVoltage) {
 }
 
 void Drive::driveDistance(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage) {
+  beginMotion();
+  driveDistanceLoop(distance, driveMaxVoltage, heading, headingMaxVoltage);
+}
+
+void Drive::driveDistanceLoop(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage) {
   targetHeading = normalize360(heading);
-  PID drivePID(driveKp, driveKi, driveKd, driveStarti, driveSettleError, driveSettleTime, driveTimeout);
+  GainPoint gains = driveGains(distance);
+  PID drivePID(gains.kp, gains.ki, gains.kd, gains.starti, gains.settleError, driveSettleTime, driveTimeout);
   PID headingPID(headingKp, headingKd);
   float startAveragePosition = (getLeftPosition() + getRightPosition()) / 2.0;
   float averagePosition = startAveragePosition;
-  while (drivePID.isDone() == false && !drivetrainNeedsStopped) {
+  motionTimer.beginMotion(TELEMETRY_DRIVE, distance, gains.settleError);
+  controlLoop.start();
+  float dt = controlLoop.getPeriod();
+  bool first = true, passed = false;
+  float driveError = distance;
+  while (drivePID.isDone() == false && !drivetrainNeedsStopped && !motionCancelled) {
+    measureVelocity(dt, first);
     averagePosition = (getLeftPosition() + getRightPosition()) / 2.0;
-    float driveError = distance + startAveragePosition - averagePosition;
+    driveError = distance + startAveragePosition - averagePosition;
+    float headingError = normalize180(targetHeading - getHeading());
+    motionTraveled = averagePosition - startAveragePosition;
+    motionHeadingError = headingError;
+    motionTimer.updateMotion(driveError, dt);
+    if (chaining && fabs(driveError) < chainDriveError) {
+      passed = true;
+      break;
+    }
+    if (first) carryVelocity(drivePID, driveError, chainVelocity, dt);
+    first = false;
+    float driveOutput = drivePID.update(driveError, dt);
+    float headingOutput = headingPID.update(headingError, dt);
+
+    driveOutput = threshold(driveOutput, -driveMaxVoltage, driveMaxVoltage);
+    headingOutput = threshold(headingOutput, -headingMaxVoltage, headingMaxVoltage);
+
+    driveWithVoltage(driveOutput + headingOutput, driveOutput - headingOutput);
+    recordTelemetry(TELEMETRY_DRIVE, driveError, drivePID, driveOutput);
+    dt = controlLoop.waitForNextTick();
+  }
+  motionTimer.endMotion(passed ? MOTION_PASSED : motionExit(drivePID));
+  if (passed) {
+    passThrough(MOTION_DRIVE, driveError, targetHeading, driveMaxVoltage, headingMaxVoltage);
+  } else {
+    brakeAfterMotion();
+    chainCarry = false;
+  }
+  motionRunning = false;
+}
+
+void Drive::driveDistanceProfiled(float distance) {
+  driveDistanceProfiled(distance, profileMaxVelocity);
+}
+
+void Drive::driveDistanceProfiled(float distance, float maxVelocity) {
+  beginMotion();
+  MotionProfile profile(distance, maxVelocity, profileMaxAcceleration, profileMaxJerk);
+  float plannedTime = profile.getTotalTime() * 1000;
+  // The timeout starts counting after the planned time.
+  GainPoint gains = driveGains(distance);
+  PID drivePID(gains.kp, gains.ki, gains.kd, gains.starti, gains.settleError, driveSettleTime, driveTimeout + plannedTime);
+  PID headingPID(headingKp, headingKd);
+  float startAveragePosition = (getLeftPosition() + getRightPosition()) / 2.0;
+  uint32_t startTime = timer::system();
+  float elapsed = 0;
+  motionTimer.beginMotion(TELEMETRY_PROFILED, distance, gains.settleError);
+  controlLoop.start();
+  float dt = controlLoop.getPeriod();
+  bool first = true, passed = false;
+  float traveled = 0;
+  // The PID may count as settled while tracking the profile, so only exit once the profile has ended.
+  while (!(elapsed >= plannedTime && drivePID.isDone()) && !drivetrainNeedsStopped && !motionCancelled) {
+    measureVelocity(dt, first);
+    first = false;
+    elapsed = timer::system() - startTime;
+    float position, velocity, acceleration;
+    profile.sample(elapsed / 1000.0, position, velocity, acceleration);
+
+    traveled = (getLeftPosition() + getRightPosition()) / 2.0 - startAveragePosition;
+    float driveError = position - traveled;
     float headingError = normalize180(targetHeading - getHeading());
-    float driveOutput = drivePID.update(driveError);
-    float headingOutput = headingPID.update(headingError);
+    motionTraveled = traveled;
+    motionHeadingError = headingError;
+    // Time against the end of the move, not the profile, which the robot tracks all the way.
+    motionTimer.updateMotion(distance - traveled, dt);
+    // The profile starts from rest, so it does not take the velocity of a previous motion,
+    // but it can still hand its own on.
+    if (chaining && fabs(distance - traveled) < chainDriveError) {
+      passed = true;
+      break;
+    }
+
+    float feedforward = driveKv * velocity + driveKa * acceleration;
+    if (velocity > 0) feedforward += driveKs;
+    if (velocity < 0) feedforward -= driveKs;
+    float driveOutput = feedforward + drivePID.update(driveError, dt);
+    float headingOutput = headingPID.update(headingError, dt);
+
+    driveOutput = threshold(driveOutput, -driveMaxVoltage, driveMaxVoltage);
+    headingOutput = threshold(headingOutput, -headingMaxVoltage, headingMaxVoltage);
+
+    driveWithVoltage(driveOutput + headingOutput, driveOutput - headingOutput);
+    recordTelemetry(TELEMETRY_PROFILED, driveError, drivePID, driveOutput);
+    dt = controlLoop.waitForNextTick();
+  }
+  motionTimer.endMotion(passed ? MOTION_PASSED : motionExit(drivePID));
+  if (passed) {
+    passThrough(MOTION_DRIVE, distance - traveled, targetHeading, driveMaxVoltage, headingMaxVoltage);
+  } else {
+    brakeAfterMotion();
+    chainCarry = false;
+  }
+  profilePlannedTime = plannedTime;
+  profileActualTime = timer::system() - startTime;
+  motionRunning = false;
+}
+
+float Drive::getProfilePlannedTime() {
+  return profilePlannedTime;
+}
+
+float Drive::getProfileActualTime() {
+  return profileActualTime;
+}
+
+// Returns the heading in degrees that points from one position to another.
+static float headingToPoint(float fromX, float fromY, float toX, float toY) {
+  return normalize360(atan2(toX - fromX, toY - fromY) * 180.0 / M_PI);
+}
+
+void Drive::turnToPoint(float x, float y) {
+  turnToPoint(x, y, turnMaxVoltage);
+}
 
+void Drive::turnToPoint(float x, float y, float turnMaxVoltage) {
+  Pose pose = getPose();
+  turnToHeading(headingToPoint(pose.x, pose.y, x, y), turnMaxVoltage);
+}
+
+void Drive::driveToPoint(float x, float y) {
+  driveToPoint(x, y, driveMaxVoltage, headingMaxVoltage);
+}
+
+void Drive::driveToPoint(float x, float y, float driveMaxVoltage, float headingMaxVoltage) {
+  Pose pose = getPose();
+  Point path[2] = {{pose.x, pose.y}, {x, y}};
+  beginMotion();
+  followPathLoop(path, 2, 0, driveMaxVoltage, headingMaxVoltage);
+}
+
+void Drive::followPath(const Point* path, int count, float lookahead) {
+  followPath(path, count, lookahead, driveMaxVoltage, headingMaxVoltage);
+}
+
+void Drive::followPath(const Point* path, int count, float lookahead, float driveMaxVoltage, float headingMaxVoltage) {
+  if (count < 1) return;
+  beginMotion();
+  followPathLoop(path, count, lookahead, driveMaxVoltage, headingMaxVoltage);
+}
+
+// Finds the point where a circle around the robot leaves the segment from a to b.
+// Returns false if the circle does not cross the segment.
+static bool lookaheadOnSegment(Point a, Point b, Pose pose, float radius, Point &result) {
+  float dx = b.x - a.x, dy = b.y - a.y;
+  float fx = a.x - pose.x, fy = a.y - pose.y;
+  float qa = dx * dx + dy * dy;
+  float qb = 2 * (fx * dx + fy * dy);
+  float qc = fx * fx + fy * fy - radius * radius;
+  float discriminant = qb * qb - 4 * qa * qc;
+  if (qa == 0 || discriminant < 0) return false;
+  // The larger root is the crossing farther along the segment.
+  float t = (-qb + sqrt(discriminant)) / (2 * qa);
+  if (t < 0 || t > 1) return false;
+  result.x = a.x + t * dx;
+  result.y = a.y + t * dy;
+  return true;
+}
+
+void Drive::followPathLoop(const Point* path, int count, float lookahead, float driveMaxVoltage, float headingMaxVoltage) {
+  // Within this distance of the end the direction to it swings quickly, so stop steering.
+  const float steeringRadius = 6;
+  Point end = path[count - 1];
+  Pose start = getPose();
+  // The gains are for the length of the whole path.
+  float pathLength = hypot(path[0].x - start.x, path[0].y - start.y);
+  for (int i = 0; i < count - 1; i++) {
+    pathLength += hypot(path[i + 1].x - path[i].x, path[i + 1].y - path[i].y);
+  }
+  GainPoint gains = driveGains(pathLength);
+  PID drivePID(gains.kp, gains.ki, gains.kd, gains.starti, gains.settleError, driveSettleTime, driveTimeout);
+  PID headingPID(headingKp, headingKd);
+  int segment = 0;
+  Point first = path[0];
+  motionTimer.beginMotion(TELEMETRY_PATH, hypot(end.x - first.x, end.y - first.y), gains.settleError);
+  controlLoop.start();
+  float dt = controlLoop.getPeriod();
+  bool firstTick = true, passed = false;
+  while (drivePID.isDone() == false && !drivetrainNeedsStopped && !motionCancelled) {
+    measureVelocity(dt, firstTick);
+    Pose pose = getPose();
+
+    // Chase the farthest point on the path that is lookahead inches away,
+    // never going back to an earlier segment.
+    Point target = end;
+    float remaining = 0;
+    float endDistance = hypot(end.x - pose.x, end.y - pose.y);
+    if (endDistance > lookahead) {
+      target = path[segment + 1 < count ? segment + 1 : segment];
+      for (int i = segment; i < count - 1; i++) {
+        Point crossing;
+        if (lookaheadOnSegment(path[i], path[i + 1], pose, lookahead, crossing)) {
+          target = crossing;
+          segment = i;
+        }
+      }
+      // Distance left along the path after the target point.
+      Point previous = target;
+      for (int i = segment + 1; i < count; i++) {
+        remaining += hypot(path[i].x - previous.x, path[i].y - previous.y);
+        previous = path[i];
+      }
+    }
+    float targetDistance = hypot(target.x - pose.x, target.y - pose.y);
+    float angleToTarget = headingToPoint(pose.x, pose.y, target.x, target.y);
+
+    if (endDistance > steeringRadius) {
+      targetHeading = angleToTarget;
+    }
+    float headingError = normalize180(targetHeading - pose.heading);
+    // Project the distance left onto the robot's heading, so it slows down while
+    // pointing away and backs up if it overshoots the end.
+    float driveError = (targetDistance + remaining) * cos(normalize180(angleToTarget - pose.heading) * M_PI / 180.0);
+    motionTraveled = hypot(pose.x - start.x, pose.y - start.y);
+    motionHeadingError = headingError;
+    motionTimer.updateMotion(driveError, dt);
+    if (chaining && fabs(driveError) < chainDriveError) {
+      passed = true;
+      break;
+    }
+    if (firstTick) carryVelocity(drivePID, driveError, chainVelocity, dt);
+    firstTick = false;
+
+    float driveOutput = drivePID.update(driveError, dt);
+    float headingOutput = headingPID.update(headingError, dt);
     driveOutput = threshold(driveOutput, -driveMaxVoltage, driveMaxVoltage);
     headingOutput = threshold(headingOutput, -headingMaxVoltage, headingMaxVoltage);
 
     driveWithVoltage(driveOutput + headingOutput, driveOutput - headingOutput);
-    wait(10, msec);
+    recordTelemetry(TELEMETRY_PATH, driveError, drivePID, driveOutput);
+    dt = controlLoop.waitForNextTick();
+  }
+  motionTimer.endMotion(passed ? MOTION_PASSED : motionExit(drivePID));
+  if (passed) {
+    chainPoint = end;
+    passThrough(MOTION_POINT, 0, 0, driveMaxVoltage, headingMaxVoltage);
+  } else {
+    brakeAfterMotion();
+    chainCarry = false;
   }
-  leftDrive.stop(hold);
-  rightDrive.stop(hold);
+  motionRunning = false;
+}
+
+void Drive::swingToHeading(float heading, SwingSide side) {
+  swingToHeading(heading, side, turnMaxVoltage);
+}
+
+void Drive::swingToHeading(float heading, SwingSide side, float turnMaxVoltage) {
+  beginMotion();
+  swingToHeadingLoop(heading, side, turnMaxVoltage);
+}
+
+void Drive::swingToHeadingLoop(float heading, SwingSide side, float turnMaxVoltage) {
+  targetHeading = normalize360(heading);
+  GainPoint gains = turnGains(normalize180(heading - getHeading()));
+  PID turnPID(gains.kp, gains.ki, gains.kd, gains.starti, gains.settleError, turnSettleTime, turnTimeout);
+  motionTimer.beginMotion(TELEMETRY_SWING, targetHeading, gains.settleError);
+  motor_group& heldSide = side == SWING_LEFT ? leftDrive : rightDrive;
+  heldSide.stop(hold);
+  controlLoop.start();
+  float dt = controlLoop.getPeriod();
+  bool first = true, passed = false;
+  while (!turnPID.isDone() && !drivetrainNeedsStopped && !motionCancelled) {
+    measureVelocity(dt, first);
+    float error = normalize180(heading - getHeading());
+    motionHeadingError = error;
+    motionTimer.updateMotion(error, dt);
+    if (chaining && fabs(error) < chainTurnError) {
+      passed = true;
+      break;
+    }
+    if (first) carryVelocity(turnPID, error, chainTurnRate, dt);
+    first = false;
+    float output = turnPID.update(error, dt);
+    output = threshold(output, -turnMaxVoltage, turnMaxVoltage);
+    // Turning clockwise moves the left side forward or the right side backward.
+    if (side == SWING_LEFT) {
+      rightDrive.spin(fwd, -output, volt);
+    } else {
+      leftDrive.spin(fwd, output, volt);
+    }
+    recordTelemetry(TELEMETRY_SWING, error, turnPID, output);
+    dt = controlLoop.waitForNextTick();
+  }
+  motionTimer.endMotion(passed ? MOTION_PASSED : motionExit(turnPID));
+  if (passed) {
+    chainSide = side;
+    passThrough(MOTION_SWING, 0, heading, turnMaxVoltage, 0);
+  } else {
+    brakeAfterMotion();
+    chainCarry = false;
+  }
+  motionRunning = false;
+}
+
+void Drive::driveArc(float radius, float angle) {
+  driveArc(radius, angle, driveMaxVoltage, headingMaxVoltage);
+}
+
+void Drive::driveArc(float radius, float angle, float driveMaxVoltage, float headingMaxVoltage) {
+  // An arc of radius 0 is a turn in place, at the turn voltage, or slower if driveMaxVoltage is lower.
+  if (radius == 0) {
+    turnToHeading(targetHeading + angle, fmin(turnMaxVoltage, driveMaxVoltage));
+    return;
+  }
+  beginMotion();
+  driveArcLoop(radius, angle, driveMaxVoltage, headingMaxVoltage);
+}
+
+void Drive::driveArcLoop(float radius, float angle, float driveMaxVoltage, float headingMaxVoltage) {
+  float startHeading = targetHeading;
+  float endHeading = normalize360(startHeading + angle);
+  // The length of the arc the center drives, and the share of it each side drives. Turning
+  // clockwise puts the left side on the outside; driving backward flips the turn direction.
+  float radians = fabs(angle) * M_PI / 180.0;
+  float length = radius * radians;
+  float direction = angle >= 0 ? 1 : -1;
+  if (radius < 0) direction = -direction;
+  float leftShare = (fabs(radius) + direction * trackWidth / 2) / fabs(radius);
+  float rightShare = (fabs(radius) - direction * trackWidth / 2) / fabs(radius);
+
+  GainPoint gains = driveGains(length);
+  PID drivePID(gains.kp, gains.ki, gains.kd, gains.starti, gains.settleError, driveSettleTime, driveTimeout);
+  PID headingPID(headingKp, headingKd);
+  float startAveragePosition = (getLeftPosition() + getRightPosition()) / 2.0;
+  motionTimer.beginMotion(TELEMETRY_ARC, length, gains.settleError);
+  controlLoop.start();
+  float dt = controlLoop.getPeriod();
+  bool first = true, passed = false;
+  float driveError = length;
+  while (drivePID.isDone() == false && !drivetrainNeedsStopped && !motionCancelled) {
+    measureVelocity(dt, first);
+    float traveled = (getLeftPosition() + getRightPosition()) / 2.0 - startAveragePosition;
+    driveError = length - traveled;
+    // The heading follows the distance along the arc, and holds the end heading past it.
+    float progress = threshold(traveled / length, 0, 1);
+    targetHeading = normalize360(startHeading + angle * progress);
+    float headingError = normalize180(targetHeading - getHeading());
+    motionTraveled = traveled;
+    motionHeadingError = headingError;
+    motionTimer.updateMotion(driveError, dt);
+    if (chaining && fabs(driveError) < chainDriveError) {
+      passed = true;
+      break;
+    }
+    if (first) carryVelocity(drivePID, driveError, chainVelocity, dt);
+    first = false;
+
+    float driveOutput = threshold(drivePID.update(driveError, dt), -driveMaxVoltage, driveMaxVoltage);
+    float headingOutput = threshold(headingPID.update(headingError, dt), -headingMaxVoltage, headingMaxVoltage);
+    float leftOutput = driveOutput * leftShare + headingOutput;
+    float rightOutput = driveOutput * rightShare - headingOutput;
+    // Keep the ratio of the two sides when the outer side would go over the limit.
+    float largest = fmax(fabs(leftOutput), fabs(rightOutput));
+    if (largest > driveMaxVoltage) {
+      leftOutput *= driveMaxVoltage / largest;
+      rightOutput *= driveMaxVoltage / largest;
+    }
+
+    driveWithVoltage(leftOutput, rightOutput);
+    recordTelemetry(TELEMETRY_ARC, driveError, drivePID, driveOutput);
+    dt = controlLoop.waitForNextTick();
+  }
+  targetHeading = endHeading;
+  motionTimer.endMotion(passed ? MOTION_PASSED : motionExit(drivePID));
+  if (passed) {
+    passThrough(MOTION_DRIVE, driveError, endHeading, driveMaxVoltage, headingMaxVoltage);
+  } else {
+    brakeAfterMotion();
+    chainCarry = false;
+  }
+  motionRunning = false;
+}
+
+MotionHandle Drive::turnToHeadingAsync(float heading) {
+  return turnToHeadingAsync(heading, turnMaxVoltage);
+}
+
+MotionHandle Drive::turnToHeadingAsync(float heading, float turnMaxVoltage) {
+  return startAsyncMotion(MOTION_TURN, heading, turnMaxVoltage, heading, 0);
+}
+
+MotionHandle Drive::driveDistanceAsync(float distance) {
+  return driveDistanceAsync(distance, driveMaxVoltage, targetHeading, headingMaxVoltage);
+}
+
+MotionHandle Drive::driveDistanceAsync(float distance, float driveMaxVoltage) {
+  return driveDistanceAsync(distance, driveMaxVoltage, targetHeading, headingMaxVoltage);
+}
+
+MotionHandle Drive::driveDistanceAsync(float distance, float driveMaxVoltage, float heading, float headingMaxVoltage) {
+  return startAsyncMotion(MOTION_DRIVE, distance, driveMaxVoltage, heading, headingMaxVoltage);
+}
+
+void Drive::beginMotion() {
+  // Only one motion can drive the motors at a time.
+  if (motionRunning) {
+    motionCancelled = true;
+    while (motionRunning) {
+      wait(5, msec);
+    }
+  }
+  motionId++;
+  motionCancelled = false;
+  motionTraveled = 0;
+  motionHeadingError = 360; // unknown until the first tick.
+  motionRunning = true;
+}
+
+MotionHandle Drive::startAsyncMotion(MotionType type, float target, float maxVoltage, float heading, float headingMaxVoltage) {
+  beginMotion();
+  asyncType = type;
+  asyncTarget = target;
+  asyncMaxVoltage = maxVoltage;
+  asyncHeading = heading;
+  asyncHeadingMaxVoltage = headingMaxVoltage;
+  thread motionThread = thread(asyncMotionTask, this);
+  return MotionHandle(this, motionId);
+}
+
+int Drive::asyncMotionTask(void* drive) {
+  Drive* self = (Drive*)drive;
+  if (self->asyncType == MOTION_TURN) {
+    self->turnToHeadingLoop(self->asyncTarget, self->asyncMaxVoltage);
+  } else {
+    self->driveDistanceLoop(self->asyncTarget, self->asyncMaxVoltage, self->asyncHeading, self->asyncHeadingMaxVoltage);
+  }
+  return 0;
+}
+
+bool Drive::isMotionRunning(int id) {
+  return motionRunning && motionId == id;
+}
+
+bool Drive::isMotionRunning() {
+  return motionRunning;
+}
+
+int Drive::getMotionId() {
+  return motionId;
+}
+
+float Drive::getMotionTraveled() {
+  return motionTraveled;
+}
+
+float Drive::getMotionHeadingError() {
+  return motionHeadingError;
+}
+
+float Drive::getControlError() {
+  return controlError;
+}
+
+float Drive::getControlOutput() {
+  return controlOutput;
+}
+
+void Drive::cancelMotion() {
+  motionCancelled = true;
+}
+
+void Drive::brakeAfterMotion() {
+  // A motion that was stopped leaves the brake to whoever stopped it, e.g. stop(coast).
+  vex::brakeType mode = motionCancelled || drivetrainNeedsStopped ? stopMode : hold;
+  leftDrive.stop(mode);
+  rightDrive.stop(mode);
+}
+
+void Drive::startChain() {
+  chaining = true;
+}
+
+void Drive::endChain() {
+  chaining = false;
+  if (!chainCarry) return;
+  // The last motion only passed through its target; run it again to settle there.
+  if (chainType == MOTION_TURN) {
+    turnToHeading(chainHeading, chainMaxVoltage);
+  } else if (chainType == MOTION_SWING) {
+    // Settle on the same pivot, so the robot stays on the swing's path.
+    swingToHeading(chainHeading, chainSide, chainMaxVoltage);
+  } else if (chainType == MOTION_POINT) {
+    driveToPoint(chainPoint.x, chainPoint.y, chainMaxVoltage, chainHeadingMaxVoltage);
+  } else {
+    driveDistance(chainTarget, chainMaxVoltage, chainHeading, chainHeadingMaxVoltage);
+  }
+}
+
+void Drive::setChainExitConditions(float driveError, float turnError) {
+  chainDriveError = driveError;
+  chainTurnError = turnError;
+}
+
+void Drive::measureVelocity(float dt, bool first) {
+  float position = (getLeftPosition() + getRightPosition()) / 2.0;
+  float heading = getHeading();
+  // The first tick of a motion keeps the velocity of the previous one, to hand it on.
+  if (!first && dt > 0) {
+    chainVelocity = (position - velocityPosition) / dt * 1000;
+    chainTurnRate = normalize180(heading - velocityHeading) / dt * 1000;
+  }
+  velocityPosition = position;
+  velocityHeading = heading;
+}
+
+void Drive::carryVelocity(PID& pid, float error, float rate, float dt) {
+  if (!chainCarry) return;
+  pid.setPreviousError(error + rate * dt / 1000);
+}
+
+void Drive::passThrough(MotionType type, float target, float heading, float maxVoltage, float headingMaxVoltage) {
+  chainCarry = true;
+  chainType = type;
+  chainTarget = target;
+  chainHeading = heading;
+  chainMaxVoltage = maxVoltage;
+  chainHeadingMaxVoltage = headingMaxVoltage;
+}
+
+MotionHandle::MotionHandle(Drive* drive, int id) :
+  drive(drive),
+  id(id) {}
+
+bool MotionHandle::isRunning() {
+  return drive->isMotionRunning(id);
+}
+
+void MotionHandle::waitUntilSettled() {
+  while (isRunning()) {
+    wait(5, msec);
+  }
+}
+
+void MotionHandle::waitUntilTraveled(float inches) {
+  while (isRunning() && fabs(drive->getMotionTraveled()) < fabs(inches)) {
+    wait(5, msec);
+  }
+}
+
+void MotionHandle::waitUntilHeadingWithin(float degrees) {
+  while (isRunning() && fabs(drive->getMotionHeadingError()) > degrees) {
+    wait(5, msec);
+  }
+}
+
+void MotionHandle::cancel() {
+  if (isRunning()) drive->cancelMotion();
 }
 
 void Drive::setArcadeConstants(float kBrake, float kTurnBias, float kTurnDampingFactor)
@@ -124,12 +820,41 @@ void Drive::setArcadeConstants(float kBrake, float kTurnBias, float kTurnDamping
   this->kTurnDampingFactor = kTurnDampingFactor;
 }
 
+void Drive::setDriverCurves(const ResponseCurve& throttleCurve, const ResponseCurve& turnCurve)
+{
+  this->throttleCurve = throttleCurve;
+  this->turnCurve = turnCurve;
+}
+
+void Drive::setOutputLimits(float slewRate, float currentBudget)
+{
+  driverLimiter.setSlewRate(slewRate);
+  driverLimiter.setCurrentBudget(currentBudget);
+}
+
+void Drive::addCurrentLoad(motor& m)
+{
+  driverLimiter.addSharedMotor(m);
+}
+
+void Drive::setThermalDerate(float startTemperature, float endTemperature, float minScale)
+{
+  driverLimiter.setThermalDerate(startTemperature, endTemperature, minScale);
+}
+
+void Drive::driveWithLimitedVoltage(float leftVoltage, float rightVoltage) {
+  driverRequested = (leftVoltage + rightVoltage) / 2;
+  driverLimiter.limit(leftDrive, rightDrive, leftVoltage, rightVoltage);
+  leftDrive.spin(fwd, leftVoltage, volt);
+  rightDrive.spin(fwd, rightVoltage, volt);
+}
+
 void Drive::controlArcade(int y, int x) {
   float throttle = deadband(y, 5);
   float turn = deadband(x, 5) * kTurnDampingFactor;
 
-  turn = curveFunction(turn, kTurn);
-  throttle = curveFunction(throttle, kThrottle);
+  turn = turnCurve.apply(turn);
+  throttle = throttleCurve.apply(throttle);
 
   float leftPower = percentToVolt(throttle + turn);
   float rightPower = percentToVolt(throttle - turn);
@@ -146,8 +871,7 @@ void Drive::controlArcade(int y, int x) {
   }
 
   if (fabs(throttle) > 0 || fabs(turn) > 0) {
-    leftDrive.spin(fwd, leftPower, volt);
-    rightDrive.spin(fwd, rightPower, volt);
+    driveWithLimitedVoltage(leftPower, rightPower);
     drivetrainNeedsStopped = true;
   }
   // When joystick are released, run active brake on drive
@@ -155,8 +879,7 @@ void Drive::controlArcade(int y, int x) {
   else {
     if (drivetrainNeedsStopped) {
       if (stopMode != hold) {
-        leftDrive.resetPosition();
-        rightDrive.resetPosition();
+        resetDrivePosition();
         wait(20, msec);
         leftDrive.spin(fwd, -leftDrive.position(rev) * kBrake, volt);
         rightDrive.spin(fwd, -rightDrive.position(rev) * kBrake, volt);
@@ -164,23 +887,24 @@ void Drive::controlArcade(int y, int x) {
         leftDrive.stop(hold);
         rightDrive.stop(hold);
       }
+      driverLimiter.reset();
       drivetrainNeedsStopped = false;
     }
   }
 }
 
 void Drive::controlTank(int left, int right) {
-  float leftthrottle = curveFunction(left, kThrottle);
-  float rightthrottle = curveFunction(right, kThrottle);
+  float leftthrottle = throttleCurve.apply(left);
+  float rightthrottle = throttleCurve.apply(right);
 
   if (fabs(leftthrottle) > 0 || fabs(rightthrottle) > 0) {
-    leftDrive.spin(fwd, percentToVolt(leftthrottle), volt);
-    rightDrive.spin(fwd, percentToVolt(rightthrottle), volt);
+    driveWithLimitedVoltage(percentToVolt(leftthrottle), percentToVolt(rightthrottle));
     drivetrainNeedsStopped = true;
   } else {
     if (drivetrainNeedsStopped) {
       leftDrive.stop(stopMode);
       rightDrive.stop(stopMode);
+      driverLimiter.reset();
       drivetrainNeedsStopped = false;
     }
   }
@@ -191,13 +915,14 @@ void Drive::controlMecanum(int x, int y, int acc, int steer, motor DriveLF, moto
   float strafe = deadband(x, 5);
   float straight = deadband(acc, 5);
   float turn = deadband(steer, 5);
-  straight = curveFunction(straight, kThrottle);
-  turn = curveFunction(turn, kTurn);
+  straight = throttleCurve.apply(straight);
+  turn = turnCurve.apply(turn);
 
   if (turn == 0 && strafe == 0 && throttle == 0 && straight == 0) {
     if (drivetrainNeedsStopped) {
       leftDrive.stop(stopMode);
       rightDrive.stop(stopMode);
+      driverLimiter.reset();
       drivetrainNeedsStopped = false;
       return;
     }
@@ -214,22 +939,66 @@ void Drive::controlMecanum(int x, int y, int acc, int steer, motor DriveLF, moto
   {
     float leftPower = percentToVolt(throttle + turn);
     float rightPower = percentToVolt(throttle - turn);
-    leftDrive.spin(fwd, leftPower, volt);
-    rightDrive.spin(fwd, rightPower, volt);
+    driveWithLimitedVoltage(leftPower, rightPower);
     drivetrainNeedsStopped = true;
   }
 }
 
 void Drive::stop(vex::brakeType mode) {
+  // Set first, so the cancelled motion brakes with it too.
+  stopMode = mode;
+  cancelMotion();
+  chaining = false;
+  chainCarry = false;
   drivetrainNeedsStopped = true;
   leftDrive.stop(mode);
   rightDrive.stop(mode);
-  stopMode = mode;
-  leftDrive.resetPosition();
-  rightDrive.resetPosition();
+  resetDrivePosition();
   drivetrainNeedsStopped = false;
 }
 
+void Drive::recordTelemetry(TelemetrySource source, float error, PID& pid, float output) {
+  recordTelemetry(source, error, pid, output, output, 0);
+}
+
+void Drive::recordTelemetry(TelemetrySource source, float error, PID& pid, float output, float requested, uint8_t limits) {
+  TelemetryRecord record;
+  record.time = timer::system();
+  record.source = source;
+  record.motion = motionId;
+  record.leftTemperature = leftDrive.temperature(celsius);
+  record.rightTemperature = rightDrive.temperature(celsius);
+  record.error = error;
+  record.p = pid.getPTerm();
+  record.i = pid.getITerm();
+  record.d = pid.getDTerm();
+  record.output = output;
+  record.heading = getHeading();
+  record.inertialHeading = getInertialHeading();
+  record.leftPosition = getLeftPosition();
+  record.rightPosition = getRightPosition();
+  record.leftCurrent = leftDrive.current(amp);
+  record.rightCurrent = rightDrive.current(amp);
+  record.requested = requested;
+  record.limits = limits;
+  controlError = error;
+  controlOutput = output;
+  telemetry.push(record);
+}
+
+void Drive::recordDriverTelemetry() {
+  // A motion started from test mode drives the motors and records its own ticks.
+  if (motionRunning) return;
+  PID noPID(0, 0);
+  float output = (leftDrive.voltage(volt) + rightDrive.voltage(volt)) / 2;
+  // While the drivetrain is stopped the limiter is not in the way.
+  if (!drivetrainNeedsStopped) {
+    recordTelemetry(TELEMETRY_DRIVER, 0, noPID, output);
+    return;
+  }
+  recordTelemetry(TELEMETRY_DRIVER, 0, noPID, output, driverRequested, driverLimiter.getActiveLimits());
+}
+
 void Drive::checkStatus(){
   int distanceTraveled = (getLeftPosition() + getRightPosition()) / 2.0;
     // Display heading and the distance traveled previously on the controller screen.
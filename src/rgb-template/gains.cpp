@@ -0,0 +1,59 @@
+#include "vex.h"
+
+bool GainSchedule::addPoint(float size, float kp, float ki, float kd, float starti, float settleError) {
+  size = fabs(size);
+  GainPoint point = {size, kp, ki, kd, starti, settleError};
+  int i = 0;
+  while (i < count && points[i].size < size) {
+    i++;
+  }
+  if (i < count && points[i].size == size) {
+    points[i] = point;
+    return true;
+  }
+  if (count == MAX_POINTS) return false;
+  // Shift the larger points up to keep the table sorted.
+  for (int j = count; j > i; j--) {
+    points[j] = points[j - 1];
+  }
+  points[i] = point;
+  count++;
+  return true;
+}
+
+void GainSchedule::clear() {
+  count = 0;
+}
+
+int GainSchedule::getCount() const {
+  return count;
+}
+
+GainPoint GainSchedule::getPoint(int i) const {
+  return points[i];
+}
+
+bool GainSchedule::lookup(float size, GainPoint& gains) const {
+  if (count == 0) return false;
+  size = fabs(size);
+  if (size <= points[0].size) {
+    gains = points[0];
+  } else if (size >= points[count - 1].size) {
+    gains = points[count - 1];
+  } else {
+    int i = 1;
+    while (points[i].size < size) {
+      i++;
+    }
+    const GainPoint& low = points[i - 1];
+    const GainPoint& high = points[i];
+    float t = (size - low.size) / (high.size - low.size);
+    gains.kp = low.kp + t * (high.kp - low.kp);
+    gains.ki = low.ki + t * (high.ki - low.ki);
+    gains.kd = low.kd + t * (high.kd - low.kd);
+    gains.starti = low.starti + t * (high.starti - low.starti);
+    gains.settleError = low.settleError + t * (high.settleError - low.settleError);
+  }
+  gains.size = size;
+  return true;
+}
@@ -0,0 +1,101 @@
+#include "vex.h"
+
+// The encoders must show no motion for this long before the inertial readings count as drift, in milliseconds.
+static const float STILL_TIME = 500;
+// The largest encoder change in inches per update that still counts as standing still.
+static const float STILL_DISTANCE = 0.002;
+// The time constants of the drift estimate and of the slip detection in seconds.
+static const float DRIFT_TIME_CONSTANT = 2;
+static const float SLIP_TIME_CONSTANT = 0.1;
+// The fastest drift an inertial sensor plausibly has, in degrees per second. Turning faster
+// while the encoders are still is the robot being turned, by hand or by a defender.
+static const float MAX_DRIFT = 0.25;
+// The time constant of the turn rate checked against MAX_DRIFT in seconds, to average out
+// the steps of the inertial readings.
+static const float STILL_RATE_TIME_CONSTANT = 0.2;
+
+void HeadingFilter::setTrackWidth(float trackWidth) {
+  this -> trackWidth = trackWidth;
+}
+
+void HeadingFilter::setFusion(float timeConstant, float slipThreshold) {
+  this -> timeConstant = timeConstant;
+  this -> slipThreshold = slipThreshold;
+}
+
+void HeadingFilter::update(float leftPosition, float rightPosition, float rotation, float dt) {
+  if (!hasPrevious) {
+    previousLeft = leftPosition;
+    previousRight = rightPosition;
+    previousRotation = rotation;
+    hasPrevious = true;
+    return;
+  }
+  float deltaLeft = leftPosition - previousLeft;
+  float deltaRight = rightPosition - previousRight;
+  float deltaRotation = rotation - previousRotation;
+  previousLeft = leftPosition;
+  previousRight = rightPosition;
+  previousRotation = rotation;
+  float seconds = dt / 1000;
+  if (seconds <= 0) return;
+
+  // Turning clockwise moves the left side forward relative to the right.
+  float encoderChange = (deltaLeft - deltaRight) / trackWidth * 180 / M_PI;
+
+  // With the encoders nearly still, a slow change of the inertial rotation that they do not show
+  // is drift, and a faster one is the robot turning without its wheels: slip, which must not be
+  // learned as drift.
+  bool turnedWithoutWheels = false;
+  if (fabs(deltaLeft) < STILL_DISTANCE && fabs(deltaRight) < STILL_DISTANCE) {
+    float rate = (deltaRotation - encoderChange) / seconds;
+    stillRate += (rate - stillRate) * seconds / (STILL_RATE_TIME_CONSTANT + seconds);
+    if (fabs(stillRate) > MAX_DRIFT) {
+      turnedWithoutWheels = true;
+      stillTime = 0;
+    } else {
+      stillTime += dt;
+    }
+    if (stillTime > STILL_TIME) {
+      drift += (rate - drift) * seconds / (DRIFT_TIME_CONSTANT + seconds);
+      drift = threshold(drift, -MAX_DRIFT, MAX_DRIFT);
+    }
+  } else {
+    stillTime = 0;
+    stillRate = 0;
+  }
+  float inertialChange = deltaRotation - drift * seconds;
+  inertialRotation += inertialChange;
+
+  mismatch += (encoderChange - inertialChange) - mismatch * seconds / (SLIP_TIME_CONSTANT + seconds);
+  slipping = turnedWithoutWheels || fabs(mismatch) > slipThreshold;
+
+  float fused = fusedRotation + (slipping ? inertialChange : encoderChange);
+  fused += (inertialRotation - fused) * seconds / (timeConstant + seconds);
+  fusedRotation = fused;
+}
+
+void HeadingFilter::resetEncoders() {
+  previousLeft = 0;
+  previousRight = 0;
+}
+
+void HeadingFilter::setHeading(float heading) {
+  headingOffset = heading - fusedRotation;
+}
+
+float HeadingFilter::getHeading() {
+  return normalize360(fusedRotation + headingOffset);
+}
+
+float HeadingFilter::getRotation() {
+  return fusedRotation;
+}
+
+float HeadingFilter::getDrift() {
+  return drift;
+}
+
+bool HeadingFilter::isSlipping() {
+  return slipping;
+}
@@ -0,0 +1,148 @@
+#include "vex.h"
+
+HealthMonitor::HealthMonitor(motor** motors, const char** names, int motorCount, inertial* inertialSensor) :
+  motors(motors),
+  names(names),
+  motorCount(fmin(motorCount, HEALTH_MAX_MOTORS)),
+  inertialSensor(inertialSensor),
+  healthLoop(250)
+{
+  memset(&snapshot, 0, sizeof(snapshot));
+  memset(reportedFaults, 0, sizeof(reportedFaults));
+}
+
+void HealthMonitor::setLimits(float temperatureLimit, float warningTime) {
+  this -> temperatureLimit = temperatureLimit;
+  this -> warningTime = warningTime;
+}
+
+void HealthMonitor::start(float periodMs) {
+  healthLoop.setPeriod(periodMs);
+  if (running) return;
+  running = true;
+  // Motors heat up over seconds, so a late sample costs nothing; the control loops go first.
+  healthLoop.startTask(healthTick, this, task::taskPriorityLow);
+}
+
+bool HealthMonitor::healthTick(float dt, void* monitor) {
+  HealthMonitor* self = (HealthMonitor*)monitor;
+  self->sample();
+  self->report(true);
+  return true;
+}
+
+bool HealthMonitor::check() {
+  sample();
+  report(false);
+  return getSnapshot().faults == 0;
+}
+
+HealthSnapshot HealthMonitor::getSnapshot() {
+  lock.lock();
+  HealthSnapshot copy = snapshot;
+  lock.unlock();
+  return copy;
+}
+
+void HealthMonitor::sample() {
+  lock.lock();
+  uint32_t now = timer::system();
+  snapshot.time = now;
+  snapshot.motorCount = motorCount;
+  snapshot.faults = 0;
+  historyTime[historyNext] = now;
+
+  for (int i = 0; i < motorCount; i++) {
+    MotorHealth& health = snapshot.motors[i];
+    motor* m = motors[i];
+    health.name = names[i];
+    health.connected = m->installed();
+    health.temperature = health.connected ? m->temperature(celsius) : 0;
+    health.current = health.connected ? m->current(amp) : 0;
+    health.power = health.connected ? m->power(watt) : 0;
+    history[i][historyNext] = health.temperature;
+  }
+  historyNext = (historyNext + 1) % HISTORY_SIZE;
+  if (historyCount < HISTORY_SIZE) historyCount++;
+
+  for (int i = 0; i < motorCount; i++) {
+    MotorHealth& health = snapshot.motors[i];
+    health.temperatureSlope = temperatureSlope(i);
+    health.timeToLimit = -1;
+    // Below a degree a minute the motor is holding its temperature.
+    if (health.temperatureSlope > 1.0 / 60) {
+      health.timeToLimit = fmax(temperatureLimit - health.temperature, 0) / health.temperatureSlope;
+    }
+    health.faults = 0;
+    if (!health.connected) {
+      health.faults |= FAULT_DISCONNECTED;
+    } else if (health.temperature >= temperatureLimit) {
+      health.faults |= FAULT_HOT;
+    } else if (health.timeToLimit >= 0 && health.timeToLimit < warningTime) {
+      health.faults |= FAULT_HEATING;
+    }
+    snapshot.faults |= health.faults;
+  }
+
+  snapshot.inertialConnected = inertialSensor->installed();
+  if (!snapshot.inertialConnected) snapshot.faults |= FAULT_DISCONNECTED;
+  lock.unlock();
+}
+
+float HealthMonitor::temperatureSlope(int motor) {
+  // A least squares fit over the whole history, since the motors report temperature in coarse steps.
+  if (historyCount < 2) return 0;
+  int first = (historyNext - historyCount + HISTORY_SIZE) % HISTORY_SIZE;
+  uint32_t start = historyTime[first];
+  float sumT = 0, sumY = 0, sumTT = 0, sumTY = 0;
+  for (int n = 0; n < historyCount; n++) {
+    int k = (first + n) % HISTORY_SIZE;
+    float t = (historyTime[k] - start) / 1000.0;
+    float y = history[motor][k];
+    sumT += t;
+    sumY += y;
+    sumTT += t * t;
+    sumTY += t * y;
+  }
+  float denominator = historyCount * sumTT - sumT * sumT;
+  if (denominator <= 0) return 0;
+  return (historyCount * sumTY - sumT * sumY) / denominator;
+}
+
+void HealthMonitor::report(bool onlyNew) {
+  HealthSnapshot current = getSnapshot();
+  bool newFault = false;
+  for (int i = 0; i < current.motorCount; i++) {
+    uint8_t faults = current.motors[i].faults;
+    if (faults & ~reportedFaults[i]) newFault = true;
+    reportedFaults[i] = faults;
+  }
+  uint8_t inertialFaults = current.inertialConnected ? 0 : FAULT_DISCONNECTED;
+  if (inertialFaults & ~reportedFaults[HEALTH_MAX_MOTORS]) newFault = true;
+  reportedFaults[HEALTH_MAX_MOTORS] = inertialFaults;
+
+  if (current.faults == 0 || (onlyNew && !newFault)) return;
+
+  // The worst faults go first, since the controller only shows the start of the alert.
+  char message[120] = "";
+  int length = 0;
+  if (inertialFaults) {
+    length += snprintf(message + length, sizeof(message) - length, "imu gone ");
+  }
+  const uint8_t order[] = { FAULT_DISCONNECTED, FAULT_HOT, FAULT_HEATING };
+  for (int n = 0; n < 3; n++) {
+    for (int i = 0; i < current.motorCount && length < (int)sizeof(message); i++) {
+      MotorHealth& health = current.motors[i];
+      if (!(health.faults & order[n])) continue;
+      if (order[n] == FAULT_DISCONNECTED) {
+        length += snprintf(message + length, sizeof(message) - length, "%s gone ", health.name);
+      } else if (order[n] == FAULT_HOT) {
+        length += snprintf(message + length, sizeof(message) - length, "%s %.0fC ", health.name, health.temperature);
+      } else {
+        length += snprintf(message + length, sizeof(message) - length, "%s %.0fs ", health.name, health.timeToLimit);
+      }
+    }
+  }
+  display.alert(message, "---");
+  printf("health: %s\n", message);
+}
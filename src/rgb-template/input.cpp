@@ -0,0 +1,149 @@
+#include "vex.h"
+
+InputDispatcher input(10);
+
+InputDispatcher::InputDispatcher(float periodMs) :
+  inputLoop(periodMs)
+{
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    changingFor[i] = 0;
+    sinceRelease[i] = 1e9;
+  }
+  for (int i = 0; i < MAX_BINDINGS; i++) {
+    downFor[i] = -1;
+  }
+}
+
+void InputDispatcher::on(InputButton button, InputEvent event, InputHandler handler) {
+  if (bindingCount >= MAX_BINDINGS) return;
+  bindings[bindingCount].buttons = 1 << button;
+  bindings[bindingCount].event = event;
+  bindings[bindingCount].handler = handler;
+  bindingCount++;
+}
+
+void InputDispatcher::onCombo(InputButton first, InputButton second, InputEvent event, InputHandler handler) {
+  if (bindingCount >= MAX_BINDINGS) return;
+  bindings[bindingCount].buttons = (1 << first) | (1 << second);
+  bindings[bindingCount].event = event;
+  bindings[bindingCount].handler = handler;
+  bindingCount++;
+}
+
+void InputDispatcher::setTimings(float debounceTime, float holdTime, float doubleTapTime) {
+  this -> debounceTime = debounceTime;
+  this -> holdTime = holdTime;
+  this -> doubleTapTime = doubleTapTime;
+}
+
+bool InputDispatcher::isPressed(InputButton button) {
+  return state & (1 << button);
+}
+
+uint16_t InputDispatcher::getState() {
+  return state;
+}
+
+void InputDispatcher::inject(uint16_t buttons, uint16_t mask) {
+  injected = buttons;
+  injectMask = mask;
+}
+
+void InputDispatcher::stopInjecting() {
+  injectMask = 0;
+}
+
+void InputDispatcher::start() {
+  if (running) return;
+  running = true;
+  inputLoop.startTask(inputTick, this, task::taskPriorityNormal);
+}
+
+bool InputDispatcher::inputTick(float dt, void* dispatcher) {
+  ((InputDispatcher*)dispatcher)->update(dt);
+  return true;
+}
+
+uint16_t InputDispatcher::sample() {
+  // In the order of InputButton.
+  controller::button* buttons[BUTTON_COUNT] = {
+    &controller1.ButtonL1, &controller1.ButtonL2, &controller1.ButtonR1, &controller1.ButtonR2,
+    &controller1.ButtonUp, &controller1.ButtonDown, &controller1.ButtonLeft, &controller1.ButtonRight,
+    &controller1.ButtonX, &controller1.ButtonB, &controller1.ButtonY, &controller1.ButtonA
+  };
+  uint16_t raw = 0;
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    if (buttons[i]->pressing()) raw |= 1 << i;
+  }
+  uint16_t mask = injectMask;
+  return (raw & ~mask) | (injected & mask);
+}
+
+void InputDispatcher::update(float dt) {
+  uint16_t raw = sample();
+  uint16_t previous = state;
+
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    uint16_t bit = 1 << i;
+    sinceRelease[i] += dt;
+    if ((raw & bit) == (state & bit)) {
+      changingFor[i] = 0;
+      continue;
+    }
+    changingFor[i] += dt;
+    if (changingFor[i] >= debounceTime) {
+      state ^= bit;
+      changingFor[i] = 0;
+    }
+  }
+
+  uint16_t pressed = state & ~previous;
+  uint16_t released = previous & ~state;
+  uint16_t doubleTapped = 0;
+  for (int i = 0; i < BUTTON_COUNT; i++) {
+    uint16_t bit = 1 << i;
+    if ((pressed & bit) && sinceRelease[i] <= doubleTapTime) {
+      doubleTapped |= bit;
+      // The second tap cannot also start the next double tap.
+      sinceRelease[i] = 1e9;
+      tapUsed |= bit;
+    }
+    if (released & bit) {
+      sinceRelease[i] = (tapUsed & bit) ? 1e9 : 0;
+      tapUsed &= ~bit;
+    }
+  }
+
+  // Releases go first, and a double tap always comes after the press of the same tap.
+  bool down[MAX_BINDINGS], wasDown[MAX_BINDINGS], held[MAX_BINDINGS];
+  for (int i = 0; i < bindingCount; i++) {
+    down[i] = (state & bindings[i].buttons) == bindings[i].buttons;
+    wasDown[i] = (previous & bindings[i].buttons) == bindings[i].buttons;
+    float heldBefore = downFor[i];
+    downFor[i] = !down[i] ? -1 : wasDown[i] ? downFor[i] + dt : 0;
+    held[i] = down[i] && heldBefore < holdTime && downFor[i] >= holdTime;
+  }
+  const InputEvent order[] = { INPUT_RELEASE, INPUT_PRESS, INPUT_DOUBLE_TAP, INPUT_HOLD };
+  for (int n = 0; n < 4; n++) {
+    for (int i = 0; i < bindingCount; i++) {
+      Binding& binding = bindings[i];
+      if (binding.event != order[n]) continue;
+      bool fire = false;
+      switch (binding.event) {
+        case INPUT_PRESS:
+          fire = down[i] && !wasDown[i];
+          break;
+        case INPUT_RELEASE:
+          fire = wasDown[i] && !down[i];
+          break;
+        case INPUT_HOLD:
+          fire = held[i];
+          break;
+        case INPUT_DOUBLE_TAP:
+          fire = down[i] && !wasDown[i] && (doubleTapped & binding.buttons);
+          break;
+      }
+      if (fire) binding.handler();
+    }
+  }
+}
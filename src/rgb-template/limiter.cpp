@@ -0,0 +1,90 @@
+#include "vex.h"
+
+void OutputLimiter::setSlewRate(float voltsPerSecond) {
+  slewRate = voltsPerSecond;
+}
+
+void OutputLimiter::setCurrentBudget(float amps) {
+  currentBudget = amps;
+}
+
+void OutputLimiter::addSharedMotor(motor& m) {
+  for (int i = 0; i < sharedCount; i++) {
+    if (sharedMotors[i] == &m) return;
+  }
+  if (sharedCount < MAX_SHARED_MOTORS) sharedMotors[sharedCount++] = &m;
+}
+
+void OutputLimiter::setThermalDerate(float startTemperature, float endTemperature, float minScale) {
+  derateStart = startTemperature;
+  derateEnd = endTemperature;
+  derateMinScale = minScale;
+}
+
+float OutputLimiter::derateScale(float temperature) {
+  if (derateEnd <= derateStart || temperature <= derateStart) return 1;
+  float t = fmin((temperature - derateStart) / (derateEnd - derateStart), 1);
+  return 1 - t * (1 - derateMinScale);
+}
+
+void OutputLimiter::reset() {
+  leftOutput = 0;
+  rightOutput = 0;
+  activeLimits = 0;
+}
+
+uint8_t OutputLimiter::getActiveLimits() {
+  return activeLimits;
+}
+
+void OutputLimiter::limit(motor_group& leftDrive, motor_group& rightDrive, float& leftVoltage, float& rightVoltage) {
+  uint32_t now = timer::system();
+  // After a pause, e.g. an auton motion, slew from what the motors are doing now.
+  if (lastTime == 0 || now - lastTime > 100) {
+    leftOutput = leftDrive.voltage(volt);
+    rightOutput = rightDrive.voltage(volt);
+  }
+  float dt = threshold((now - lastTime) / 1000.0, 0, 0.1);
+  lastTime = now;
+  activeLimits = 0;
+
+  // The thermal scale moves at most half of its range per second.
+  float step = 0.5 * dt;
+  leftScale += threshold(derateScale(leftDrive.temperature(celsius)) - leftScale, -step, step);
+  rightScale += threshold(derateScale(rightDrive.temperature(celsius)) - rightScale, -step, step);
+  if (leftScale < 1 || rightScale < 1) activeLimits |= LIMIT_THERMAL;
+  leftVoltage *= leftScale;
+  rightVoltage *= rightScale;
+
+  if (slewRate > 0) {
+    float maxStep = slewRate * dt;
+    float left = leftOutput + threshold(leftVoltage - leftOutput, -maxStep, maxStep);
+    float right = rightOutput + threshold(rightVoltage - rightOutput, -maxStep, maxStep);
+    if (left != leftVoltage || right != rightVoltage) activeLimits |= LIMIT_SLEW;
+    leftVoltage = left;
+    rightVoltage = right;
+  }
+
+  if (currentBudget > 0) {
+    // A motor draws current in proportion to the voltage above its back EMF, which is about
+    // 12 volts at full speed, up to its stall current.
+    float leftEmf = leftDrive.velocity(pct) * 12 / 100;
+    float rightEmf = rightDrive.velocity(pct) * 12 / 100;
+    float leftCurrent = leftDrive.count() * fmin(fabs(leftVoltage - leftEmf) / 12, 1) * stallCurrent;
+    float rightCurrent = rightDrive.count() * fmin(fabs(rightVoltage - rightEmf) / 12, 1) * stallCurrent;
+    float available = currentBudget;
+    for (int i = 0; i < sharedCount; i++) {
+      available -= sharedMotors[i]->current(amp);
+    }
+    available = fmax(available, 0);
+    if (leftCurrent + rightCurrent > available) {
+      float scale = available / (leftCurrent + rightCurrent);
+      leftVoltage = leftEmf + (leftVoltage - leftEmf) * scale;
+      rightVoltage = rightEmf + (rightVoltage - rightEmf) * scale;
+      activeLimits |= LIMIT_CURRENT;
+    }
+  }
+
+  leftOutput = leftVoltage;
+  rightOutput = rightVoltage;
+}
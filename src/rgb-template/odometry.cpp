@@ -0,0 +1,61 @@
+#include "vex.h"
+
+void Odometry::update(float leftPosition, float rightPosition, float rotation) {
+  if (!hasPrevious) {
+    previousLeft = leftPosition;
+    previousRight = rightPosition;
+    previousRotation = rotation;
+    hasPrevious = true;
+    return;
+  }
+  float deltaCenter = (leftPosition - previousLeft + rightPosition - previousRight) / 2.0;
+  float deltaTheta = (rotation - previousRotation) * M_PI / 180.0;
+  previousLeft = leftPosition;
+  previousRight = rightPosition;
+  previousRotation = rotation;
+
+  // The robot moved along an arc, so it moved by the chord of that arc
+  // in the direction of the average heading.
+  float chord = deltaCenter;
+  if (fabs(deltaTheta) > 1e-6) {
+    chord = 2 * sin(deltaTheta / 2) * deltaCenter / deltaTheta;
+  }
+  float averageHeading = headingRad + deltaTheta / 2;
+
+  sequence++;
+  x += chord * sin(averageHeading);
+  y += chord * cos(averageHeading);
+  headingRad += deltaTheta;
+  sequence++;
+}
+
+void Odometry::resetEncoders() {
+  previousLeft = 0;
+  previousRight = 0;
+}
+
+Pose Odometry::getPose() {
+  Pose pose;
+  uint32_t start;
+  do {
+    start = sequence;
+    pose.x = x;
+    pose.y = y;
+    pose.heading = normalize360(headingRad * 180.0 / M_PI);
+  } while ((start & 1) || start != sequence);
+  return pose;
+}
+
+void Odometry::setPose(Pose pose) {
+  sequence++;
+  x = pose.x;
+  y = pose.y;
+  headingRad = pose.heading * M_PI / 180.0;
+  sequence++;
+}
+
+void Odometry::setHeading(float heading) {
+  sequence++;
+  headingRad = heading * M_PI / 180.0;
+  sequence++;
+}
@@ -0,0 +1,94 @@
+#include "vex.h"
+
+MotionProfile::MotionProfile(float distance, float maxVelocity, float maxAcceleration, float maxJerk) {
+  direction = distance < 0 ? -1 : 1;
+  this -> distance = fabs(distance);
+  for (int i = 0; i < 7; i++) {
+    phaseTime[i] = 0;
+    phaseJerk[i] = 0;
+    phaseAcceleration[i] = 0;
+  }
+  peakVelocity = 0;
+  totalTime = 0;
+  if (this -> distance == 0 || maxVelocity <= 0 || maxAcceleration <= 0) return;
+
+  // Speeding up and slowing down take velocity * rampTime together.
+  // If that is too far to reach maxVelocity, search for the highest velocity that fits.
+  float acceleration, jerkTime, accelerationTime;
+  float velocity = maxVelocity;
+  if (velocity * rampTime(velocity, maxAcceleration, maxJerk, acceleration, jerkTime, accelerationTime) > this -> distance) {
+    float low = 0, high = maxVelocity;
+    for (int i = 0; i < 30; i++) {
+      velocity = (low + high) / 2;
+      if (velocity * rampTime(velocity, maxAcceleration, maxJerk, acceleration, jerkTime, accelerationTime) > this -> distance) {
+        high = velocity;
+      } else {
+        low = velocity;
+      }
+    }
+    velocity = low;
+    if (velocity <= 0) return;
+  }
+  float ramp = rampTime(velocity, maxAcceleration, maxJerk, acceleration, jerkTime, accelerationTime);
+  float cruiseTime = (this -> distance - velocity * ramp) / velocity;
+  if (cruiseTime < 0) cruiseTime = 0;
+
+  float jerk = maxJerk > 0 ? maxJerk : 0;
+  float times[7] = {jerkTime, accelerationTime, jerkTime, cruiseTime, jerkTime, accelerationTime, jerkTime};
+  float jerks[7] = {jerk, 0, -jerk, 0, -jerk, 0, jerk};
+  float accelerations[7] = {0, acceleration, acceleration, 0, 0, -acceleration, -acceleration};
+  for (int i = 0; i < 7; i++) {
+    phaseTime[i] = times[i];
+    phaseJerk[i] = jerks[i];
+    phaseAcceleration[i] = accelerations[i];
+    totalTime += times[i];
+  }
+  peakVelocity = velocity;
+}
+
+float MotionProfile::rampTime(float velocity, float maxAcceleration, float maxJerk, float &acceleration, float &jerkTime, float &accelerationTime) {
+  acceleration = maxAcceleration;
+  jerkTime = 0;
+  if (maxJerk > 0) {
+    jerkTime = acceleration / maxJerk;
+    // Too slow to reach the full acceleration before it has to ramp back down.
+    if (velocity < acceleration * jerkTime) {
+      acceleration = sqrt(velocity * maxJerk);
+      jerkTime = acceleration / maxJerk;
+    }
+  }
+  accelerationTime = velocity / acceleration - jerkTime;
+  if (accelerationTime < 0) accelerationTime = 0;
+  return 2 * jerkTime + accelerationTime;
+}
+
+float MotionProfile::getTotalTime() {
+  return totalTime;
+}
+
+float MotionProfile::getPeakVelocity() {
+  return peakVelocity * direction;
+}
+
+void MotionProfile::sample(float t, float &position, float &velocity, float &acceleration) {
+  float p = 0, v = 0;
+  if (t < 0) t = 0;
+  for (int i = 0; i < 7; i++) {
+    float a = phaseAcceleration[i];
+    float j = phaseJerk[i];
+    if (t <= phaseTime[i]) {
+      position = direction * (p + v * t + a * t * t / 2 + j * t * t * t / 6);
+      velocity = direction * (v + a * t + j * t * t / 2);
+      acceleration = direction * (a + j * t);
+      return;
+    }
+    float d = phaseTime[i];
+    p += v * d + a * d * d / 2 + j * d * d * d / 6;
+    v += a * d + j * d * d / 2;
+    t -= d;
+  }
+  // The profile has finished.
+  position = direction * distance;
+  velocity = 0;
+  acceleration = 0;
+}
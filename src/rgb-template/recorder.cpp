@@ -0,0 +1,196 @@
+#include "vex.h"
+
+// Converts a value to tenths, clamped to int16.
+static int16_t toTenths(float value) {
+  return threshold(round(value * 10), -32768, 32767);
+}
+
+DriverRecorder::DriverRecorder(Drive* drive) :
+  drive(drive),
+  playbackButtons((1 << BUTTON_L1) | (1 << BUTTON_L2) | (1 << BUTTON_R1) | (1 << BUTTON_R2)) {}
+
+void DriverRecorder::setPlaybackButtons(uint16_t buttons) {
+  playbackButtons = buttons;
+}
+
+void DriverRecorder::setCorrection(float kDistance, float kHeading) {
+  this -> kDistance = kDistance;
+  this -> kHeading = kHeading;
+}
+
+bool DriverRecorder::isRecording() {
+  return recording;
+}
+
+bool DriverRecorder::isPlaying() {
+  return playing;
+}
+
+int DriverRecorder::getCount() {
+  return recordingCount;
+}
+
+const char* DriverRecorder::getName(int index) {
+  if (index < 0 || index >= recordingCount) return "";
+  return recordingNames[index];
+}
+
+int DriverRecorder::scan() {
+  recordingCount = 0;
+  if (!Brain.SDcard.isInserted()) return 0;
+  for (int i = 1; i <= MAX_RECORDINGS; i++) {
+    char filename[12];
+    snprintf(filename, sizeof(filename), "rec%d.bin", i);
+    if (!Brain.SDcard.exists(filename)) continue;
+    recordingNumbers[recordingCount] = i;
+    snprintf(recordingNames[recordingCount], sizeof(recordingNames[0]), "rec%d", i);
+    recordingCount++;
+  }
+  return recordingCount;
+}
+
+void DriverRecorder::relativePose(float& x, float& y, float& heading) {
+  Pose pose = drive->getPose();
+  float dx = pose.x - startPose.x;
+  float dy = pose.y - startPose.y;
+  float startHeading = startPose.heading * M_PI / 180;
+  // Heading 0 drives along +y and headings are clockwise, so the heading direction is (sin, cos).
+  x = dx * cos(startHeading) - dy * sin(startHeading);
+  y = dx * sin(startHeading) + dy * cos(startHeading);
+  heading = normalize180(pose.heading - startPose.heading);
+}
+
+void DriverRecorder::startRecording(int driveMode) {
+  if (recording || playing) return;
+  this -> driveMode = driveMode;
+  tickCount = 0;
+  startTime = timer::system();
+  startPose = drive->getPose();
+  recording = true;
+}
+
+void DriverRecorder::recordTick() {
+  if (!recording) return;
+  // A full recording stops by itself; the driver still has to stop it to save it.
+  if (tickCount >= MAX_TICKS) return;
+  RecordedTick& tick = ticks[tickCount];
+  tick.time = timer::system() - startTime;
+  tick.axes[0] = controller1.Axis1.position();
+  tick.axes[1] = controller1.Axis2.position();
+  tick.axes[2] = controller1.Axis3.position();
+  tick.axes[3] = controller1.Axis4.position();
+  tick.buttons = input.getState();
+  float x, y, heading;
+  relativePose(x, y, heading);
+  tick.x = toTenths(x);
+  tick.y = toTenths(y);
+  tick.heading = toTenths(heading);
+  tick.reserved = 0;
+  tickCount++;
+}
+
+int DriverRecorder::stopRecording() {
+  if (!recording) return 0;
+  recording = false;
+  int number = save();
+  scan();
+  return number;
+}
+
+int DriverRecorder::save() {
+  if (tickCount == 0 || !Brain.SDcard.isInserted()) return 0;
+  // Keep the earlier recordings: use the first unused file name.
+  int number = 0;
+  char filename[12];
+  for (int i = 1; i <= MAX_RECORDINGS && number == 0; i++) {
+    snprintf(filename, sizeof(filename), "rec%d.bin", i);
+    if (!Brain.SDcard.exists(filename)) number = i;
+  }
+  if (number == 0) return 0;
+
+  // The header holds a magic number, the format version, the tick size and the drive mode.
+  uint8_t header[12] = {'R', 'G', 'B', 'R'};
+  uint16_t version = RECORDING_VERSION, size = sizeof(RecordedTick);
+  memcpy(header + 4, &version, 2);
+  memcpy(header + 6, &size, 2);
+  header[8] = driveMode;
+  int length = tickCount * sizeof(RecordedTick);
+  if (Brain.SDcard.savefile(filename, header, sizeof(header)) != sizeof(header)) return 0;
+  if (Brain.SDcard.appendfile(filename, (uint8_t*)ticks, length) != length) return 0;
+  return number;
+}
+
+bool DriverRecorder::load(int number) {
+  char filename[12];
+  snprintf(filename, sizeof(filename), "rec%d.bin", number);
+  static uint8_t buffer[12 + MAX_TICKS * sizeof(RecordedTick)];
+  int length = Brain.SDcard.loadfile(filename, buffer, sizeof(buffer));
+  uint16_t version, size;
+  memcpy(&version, buffer + 4, 2);
+  memcpy(&size, buffer + 6, 2);
+  if (length < 12 || memcmp(buffer, "RGBR", 4) != 0 || version != RECORDING_VERSION || size != sizeof(RecordedTick)) {
+    return false;
+  }
+  driveMode = buffer[8];
+  tickCount = (length - 12) / sizeof(RecordedTick);
+  memcpy(ticks, buffer + 12, tickCount * sizeof(RecordedTick));
+  return true;
+}
+
+void DriverRecorder::play(int index) {
+  if (recording || playing || index < 0 || index >= recordingCount) return;
+  if (!load(recordingNumbers[index])) {
+    display.alert("bad recording", "---");
+    return;
+  }
+  playing = true;
+  startTime = timer::system();
+  startPose = drive->getPose();
+
+  // After the last tick, the sticks stay centered for a while so the correction can finish
+  // bringing the robot to where the recording ended.
+  int settleTicks = SETTLE_TIME / 20;
+  for (int i = 0; i < tickCount + settleTicks; i++) {
+    bool settling = i >= tickCount;
+    RecordedTick& tick = ticks[settling ? tickCount - 1 : i];
+    // Keep to the recorded timeline, even if a tick runs late.
+    uint32_t tickTime = settling ? tick.time + (i - tickCount + 1) * 20 : tick.time;
+    int32_t remaining = (int32_t)(startTime + tickTime - timer::system());
+    if (remaining > 0) wait(remaining, msec);
+
+    // The error between the recorded pose and the current one, along the robot's heading and in heading.
+    float x, y, heading;
+    relativePose(x, y, heading);
+    float radians = heading * M_PI / 180;
+    float along = (tick.x / 10.0 - x) * sin(radians) + (tick.y / 10.0 - y) * cos(radians);
+    float headingError = normalize180(tick.heading / 10.0 - heading);
+    if (settling && fabs(along) < 0.5 && fabs(headingError) < 1) break;
+    float throttleCorrection = kDistance * along;
+    float turnCorrection = kHeading * headingError;
+
+    // The same axes usercontrol() passes for each drive mode. Mecanum recordings are played
+    // back as arcade drive, without strafing.
+    int8_t centered[4] = {0, 0, 0, 0};
+    int8_t* axes = settling ? centered : tick.axes;
+    switch (driveMode) {
+    case 0:
+      drive->controlArcade(threshold(axes[1] + throttleCorrection, -100, 100), threshold(axes[3] + turnCorrection, -100, 100));
+      break;
+    case 1:
+      drive->controlArcade(threshold(axes[2] + throttleCorrection, -100, 100), threshold(axes[3] + turnCorrection, -100, 100));
+      break;
+    case 2:
+      drive->controlTank(threshold(axes[2] + throttleCorrection + turnCorrection, -100, 100),
+                         threshold(axes[1] + throttleCorrection - turnCorrection, -100, 100));
+      break;
+    default:
+      drive->controlArcade(threshold(axes[1] + throttleCorrection, -100, 100), threshold(axes[0] + turnCorrection, -100, 100));
+      break;
+    }
+    input.inject(tick.buttons, playbackButtons);
+  }
+
+  input.stopInjecting();
+  drive->stop(brake);
+  playing = false;
+}
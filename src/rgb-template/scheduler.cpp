@@ -0,0 +1,88 @@
+#include "vex.h"
+
+Scheduler::Scheduler(float periodMs) {
+  setPeriod(periodMs);
+}
+
+void Scheduler::setPeriod(float periodMs) {
+  if (periodMs < 1) periodMs = 1; // the brain's scheduler runs on a 1 ms tick.
+  period = periodMs * 1000;
+}
+
+float Scheduler::getPeriod() {
+  return period / 1000.0;
+}
+
+void Scheduler::start() {
+  previousTick = timer::systemHighResolution();
+  deadline = previousTick + period;
+  tickCount = 0;
+  overrunCount = 0;
+  lastJitter = 0;
+  maxJitter = 0;
+  totalJitter = 0;
+}
+
+float Scheduler::waitForNextTick() {
+  uint64_t now = timer::systemHighResolution();
+  if (now > deadline) {
+    // The loop body ran past the deadline.
+    overrunCount++;
+    // Skip the missed ticks instead of bursting to catch up.
+    if (now - deadline >= period) deadline = now;
+  } else {
+    this_thread::sleep_for((deadline - now) / 1000);
+    now = timer::systemHighResolution();
+  }
+
+  lastJitter = (now > deadline ? now - deadline : deadline - now) / 1000.0;
+  if (lastJitter > maxJitter) maxJitter = lastJitter;
+  totalJitter += lastJitter;
+  tickCount++;
+
+  float dt = (now - previousTick) / 1000.0;
+  previousTick = now;
+  deadline += period;
+  return dt;
+}
+
+void Scheduler::run(bool (*callback)(float dt, void* arg), void* arg) {
+  start();
+  float dt = getPeriod();
+  while (callback(dt, arg)) {
+    dt = waitForNextTick();
+  }
+}
+
+void Scheduler::startTask(bool (*callback)(float dt, void* arg), void* arg, int32_t priority) {
+  taskCallback = callback;
+  taskArg = arg;
+  task loopThread = task(loopTask, this, priority);
+}
+
+int Scheduler::loopTask(void* scheduler) {
+  Scheduler* self = (Scheduler*)scheduler;
+  self->run(self->taskCallback, self->taskArg);
+  return 0;
+}
+
+int Scheduler::getTickCount() {
+  return tickCount;
+}
+
+int Scheduler::getOverrunCount() {
+  return overrunCount;
+}
+
+float Scheduler::getLastJitter() {
+  return lastJitter;
+}
+
+float Scheduler::getMaxJitter() {
+  return maxJitter;
+}
+
+float Scheduler::getAverageJitter() {
+  if (tickCount == 0) return 0;
+  return totalJitter / tickCount;
+}
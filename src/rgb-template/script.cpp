@@ -0,0 +1,261 @@
+#include "vex.h"
+
+// The drive commands: the keyword, its op, and how many arguments it takes.
+struct ScriptKeyword
+{
+  const char* name;
+  ScriptOp op;
+  int minArguments, maxArguments;
+};
+
+static const ScriptKeyword KEYWORDS[] = {
+  {"drive", SCRIPT_DRIVE, 1, 4},
+  {"profiled", SCRIPT_PROFILED, 1, 2},
+  {"turn", SCRIPT_TURN, 1, 2},
+  {"face", SCRIPT_FACE, 2, 3},
+  {"goto", SCRIPT_GOTO, 2, 4},
+  {"heading", SCRIPT_HEADING, 1, 1},
+  {"pose", SCRIPT_POSE, 3, 3},
+  {"wait", SCRIPT_WAIT, 1, 1}
+};
+static const int KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+
+AutonScripts::AutonScripts(Drive* drive) :
+  drive(drive) {}
+
+void AutonScripts::addAction(const char* name, void (*function)(float value)) {
+  if (actionCount >= MAX_ACTIONS) return;
+  actions[actionCount].name = name;
+  actions[actionCount].function = function;
+  actionCount++;
+}
+
+int AutonScripts::getCount() {
+  return scriptCount;
+}
+
+const char* AutonScripts::getName(int index) {
+  if (index < 0 || index >= scriptCount) return "";
+  return names[index];
+}
+
+int AutonScripts::getStepCount(int index) {
+  if (index < 0 || index >= scriptCount) return 0;
+  return instructionCounts[index];
+}
+
+bool AutonScripts::parseLine(char* text, int lineNumber, ScriptInstruction& instruction, bool& empty, char* name, char* error) {
+  char* comment = strchr(text, '#');
+  if (comment) *comment = '\0';
+
+  // Split into words in place. Not strtok: the command task can parse while another task loads.
+  char* words[6];
+  int wordCount = 0;
+  char* c = text;
+  while (*c && wordCount < 6) {
+    while (*c == ' ' || *c == '\t' || *c == '\r') *c++ = '\0';
+    if (!*c) break;
+    words[wordCount++] = c;
+    while (*c && *c != ' ' && *c != '\t' && *c != '\r') c++;
+  }
+  while (*c == ' ' || *c == '\t' || *c == '\r') c++;
+  if (*c) {
+    sprintf(error, "line %d: too many words", lineNumber);
+    return false;
+  }
+  empty = wordCount == 0;
+  if (empty) return true;
+
+  if (strcmp(words[0], "name") == 0) {
+    empty = true;
+    if (wordCount != 2) {
+      sprintf(error, "line %d: name needs one word", lineNumber);
+      return false;
+    }
+    snprintf(name, 24, "%s", words[1]);
+    return true;
+  }
+
+  instruction.line = lineNumber;
+  instruction.action = 0;
+  instruction.argumentCount = wordCount - 1;
+  for (int i = 1; i < wordCount && i <= 4; i++) {
+    char* end;
+    // Actions also take on and off.
+    if (strcmp(words[i], "on") == 0) {
+      instruction.arguments[i - 1] = 1;
+    } else if (strcmp(words[i], "off") == 0) {
+      instruction.arguments[i - 1] = 0;
+    } else {
+      instruction.arguments[i - 1] = strtof(words[i], &end);
+      if (*end != '\0') {
+        sprintf(error, "line %d: %.12s is not a number", lineNumber, words[i]);
+        return false;
+      }
+    }
+  }
+
+  for (int k = 0; k < KEYWORD_COUNT; k++) {
+    if (strcmp(words[0], KEYWORDS[k].name) != 0) continue;
+    if (wordCount - 1 < KEYWORDS[k].minArguments || wordCount - 1 > KEYWORDS[k].maxArguments) {
+      sprintf(error, "line %d: %s takes %d to %d numbers", lineNumber, KEYWORDS[k].name, KEYWORDS[k].minArguments, KEYWORDS[k].maxArguments);
+      return false;
+    }
+    // drive takes 1, 2 or 4 numbers, goto 2 or 4: the heading voltage comes with the heading.
+    if ((KEYWORDS[k].op == SCRIPT_DRIVE || KEYWORDS[k].op == SCRIPT_GOTO) && wordCount - 1 == KEYWORDS[k].maxArguments - 1) {
+      sprintf(error, "line %d: %s needs both voltages", lineNumber, KEYWORDS[k].name);
+      return false;
+    }
+    instruction.op = KEYWORDS[k].op;
+    return true;
+  }
+
+  for (int a = 0; a < actionCount; a++) {
+    if (strcmp(words[0], actions[a].name) != 0) continue;
+    if (wordCount > 2) {
+      sprintf(error, "line %d: %s takes on, off or a number", lineNumber, actions[a].name);
+      return false;
+    }
+    instruction.op = SCRIPT_ACTION;
+    instruction.action = a;
+    if (wordCount == 1) instruction.arguments[0] = 1;
+    return true;
+  }
+
+  sprintf(error, "line %d: unknown command %.12s", lineNumber, words[0]);
+  return false;
+}
+
+int AutonScripts::parse(const char* text, ScriptInstruction* out, int maxCount, char* name, char* error) {
+  int count = 0;
+  int lineNumber = 0;
+  const char* start = text;
+  while (*start) {
+    lineNumber++;
+    const char* end = strchr(start, '\n');
+    int length = end ? end - start : strlen(start);
+    char line[80];
+    snprintf(line, sizeof(line), "%.*s", length, start);
+    start = end ? end + 1 : start + length;
+
+    ScriptInstruction instruction;
+    bool empty;
+    if (!parseLine(line, lineNumber, instruction, empty, name, error)) return -1;
+    if (empty) continue;
+    if (count >= maxCount) {
+      sprintf(error, "line %d: more than %d steps", lineNumber, maxCount);
+      return -1;
+    }
+    out[count++] = instruction;
+  }
+  return count;
+}
+
+int AutonScripts::load() {
+  // The instructions cannot change under a running script.
+  while (running) {
+    wait(20, msec);
+  }
+  scriptCount = 0;
+  if (!Brain.SDcard.isInserted()) return 0;
+
+  static char text[MAX_TEXT + 1];
+  for (int number = 1; number <= MAX_SCRIPTS; number++) {
+    char filename[16];
+    snprintf(filename, sizeof(filename), "script%d.txt", number);
+    if (!Brain.SDcard.exists(filename)) continue;
+    int length = Brain.SDcard.loadfile(filename, (uint8_t*)text, MAX_TEXT);
+    text[length > 0 ? length : 0] = '\0';
+
+    char name[24], error[48];
+    snprintf(name, sizeof(name), "script%d", number);
+    int count = parse(text, instructions[scriptCount], MAX_INSTRUCTIONS, name, error);
+    if (count < 0) {
+      char message[64];
+      snprintf(message, sizeof(message), "script%d %s", number, error);
+      display.alert(message, "---");
+      printf("error %s\n", message);
+      continue;
+    }
+    instructionCounts[scriptCount] = count;
+    strcpy(names[scriptCount], name);
+    scriptCount++;
+  }
+  return scriptCount;
+}
+
+int AutonScripts::save(int number, const char* text, char* error) {
+  if (number < 1 || number > MAX_SCRIPTS) {
+    sprintf(error, "script number must be 1 to %d", MAX_SCRIPTS);
+    return -1;
+  }
+  // Check it first, so a typo does not replace a working script.
+  static ScriptInstruction check[MAX_INSTRUCTIONS];
+  char name[24];
+  int count = parse(text, check, MAX_INSTRUCTIONS, name, error);
+  if (count < 0) return -1;
+
+  char filename[16];
+  snprintf(filename, sizeof(filename), "script%d.txt", number);
+  int length = strlen(text);
+  if (!Brain.SDcard.isInserted() || Brain.SDcard.savefile(filename, (uint8_t*)text, length) != length) {
+    sprintf(error, "cannot write %s", filename);
+    return -1;
+  }
+  load();
+  return count;
+}
+
+void AutonScripts::execute(const ScriptInstruction& instruction) {
+  const float* a = instruction.arguments;
+  int n = instruction.argumentCount;
+  switch (instruction.op) {
+  case SCRIPT_DRIVE:
+    if (n == 1) drive->driveDistance(a[0]);
+    else if (n == 2) drive->driveDistance(a[0], a[1]);
+    else drive->driveDistance(a[0], a[1], a[2], a[3]);
+    break;
+  case SCRIPT_PROFILED:
+    if (n == 1) drive->driveDistanceProfiled(a[0]);
+    else drive->driveDistanceProfiled(a[0], a[1]);
+    break;
+  case SCRIPT_TURN:
+    if (n == 1) drive->turnToHeading(a[0]);
+    else drive->turnToHeading(a[0], a[1]);
+    break;
+  case SCRIPT_FACE:
+    if (n == 2) drive->turnToPoint(a[0], a[1]);
+    else drive->turnToPoint(a[0], a[1], a[2]);
+    break;
+  case SCRIPT_GOTO:
+    if (n == 2) drive->driveToPoint(a[0], a[1]);
+    else drive->driveToPoint(a[0], a[1], a[2], a[3]);
+    break;
+  case SCRIPT_HEADING:
+    drive->setHeading(a[0]);
+    break;
+  case SCRIPT_POSE:
+    drive->setPose(a[0], a[1], a[2]);
+    break;
+  case SCRIPT_WAIT:
+    wait(a[0], msec);
+    break;
+  case SCRIPT_ACTION:
+    actions[instruction.action].function(a[0]);
+    break;
+  }
+}
+
+int AutonScripts::run(int index, int step, bool singleStep) {
+  if (index < 0 || index >= scriptCount) return step;
+  running = true;
+  int count = instructionCounts[index];
+  while (step < count) {
+    motionTimer.setStep(step);
+    execute(instructions[index][step]);
+    step++;
+    if (singleStep) break;
+  }
+  running = false;
+  return step;
+}
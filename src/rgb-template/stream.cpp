@@ -0,0 +1,83 @@
+#include "vex.h"
+
+// Converts a value to fixed point with the given scale, clamped to int16.
+static int16_t toFixed(float value, float scale) {
+  return threshold(round(value * scale), -32768, 32767);
+}
+
+TelemetryStream::TelemetryStream(Drive* drive) :
+  drive(drive),
+  streamLoop(20) {}
+
+void TelemetryStream::start(float periodMs) {
+  streamLoop.setPeriod(periodMs);
+  if (running) return;
+  running = true;
+  // A frame sent late only shifts a point on the host's plot, so the control loops go first.
+  streamLoop.startTask(streamTick, this, task::taskPriorityLow);
+}
+
+bool TelemetryStream::streamTick(float dt, void* stream) {
+  ((TelemetryStream*)stream)->send();
+  return true;
+}
+
+void TelemetryStream::sample(int16_t* values, uint8_t& flags, uint8_t& motion) {
+  Pose pose = drive->getPose();
+  values[0] = toFixed(pose.x, 10);
+  values[1] = toFixed(pose.y, 10);
+  values[2] = toFixed(drive->getHeading(), 10);
+  values[3] = toFixed(drive->getLeftPosition(), 10);
+  values[4] = toFixed(drive->getRightPosition(), 10);
+  values[5] = toFixed(drive->getControlError(), 10);
+  values[6] = toFixed(drive->getControlOutput(), 100);
+  values[7] = toFixed(Brain.Battery.voltage(volt), 100);
+  flags = drive->isMotionRunning() ? 1 : 0;
+  motion = drive->getMotionId();
+}
+
+void TelemetryStream::send() {
+  int16_t values[VALUE_COUNT];
+  uint8_t flags, motion;
+  sample(values, flags, motion);
+  uint32_t now = timer::system();
+  sequence++;
+
+  bool keyframe = sinceKeyframe < 0 || sinceKeyframe >= KEYFRAME_INTERVAL || now - sentTime > 255;
+  for (int i = 0; i < VALUE_COUNT && !keyframe; i++) {
+    int delta = values[i] - sent[i];
+    if (delta < -128 || delta > 127) keyframe = true;
+  }
+
+  uint8_t payload[4 + 2 * VALUE_COUNT];
+  bool sentFrame;
+  if (keyframe) {
+    uint16_t time = now;
+    memcpy(payload, &time, 2);
+    payload[2] = flags;
+    payload[3] = motion;
+    memcpy(payload + 4, values, sizeof(values));
+    sentFrame = sendFrame(STREAM_KEYFRAME, sequence, payload, 4 + 2 * VALUE_COUNT);
+  } else {
+    payload[0] = now - sentTime;
+    payload[1] = flags;
+    payload[2] = motion;
+    for (int i = 0; i < VALUE_COUNT; i++) {
+      payload[3 + i] = (int8_t)(values[i] - sent[i]);
+    }
+    sentFrame = sendFrame(STREAM_DELTA, sequence, payload, 3 + VALUE_COUNT);
+  }
+
+  // A full serial buffer drops the sample; the next delta is taken from the last one sent.
+  if (!sentFrame) {
+    skipped++;
+    return;
+  }
+  memcpy(sent, values, sizeof(values));
+  sentTime = now;
+  sinceKeyframe = keyframe ? 1 : sinceKeyframe + 1;
+}
+
+int TelemetryStream::getSkipped() {
+  return skipped;
+}
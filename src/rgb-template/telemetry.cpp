@@ -0,0 +1,91 @@
+#include "vex.h"
+
+Telemetry telemetry;
+
+Telemetry::Telemetry() :
+  head(0),
+  tail(0),
+  dropped(0)
+{
+  filename[0] = '\0';
+}
+
+bool Telemetry::push(const TelemetryRecord& record) {
+  uint32_t h = head.load(std::memory_order_relaxed);
+  if (h - tail.load(std::memory_order_acquire) >= CAPACITY) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  records[h & (CAPACITY - 1)] = record;
+  // Publish the record only after it is fully written.
+  head.store(h + 1, std::memory_order_release);
+  return true;
+}
+
+int Telemetry::pop(TelemetryRecord* out, int maxCount) {
+  uint32_t t = tail.load(std::memory_order_relaxed);
+  uint32_t available = head.load(std::memory_order_acquire) - t;
+  int count = available < (uint32_t)maxCount ? available : maxCount;
+  for (int i = 0; i < count; i++) {
+    out[i] = records[(t + i) & (CAPACITY - 1)];
+  }
+  // Hand the slots back to the producer only after they are copied out.
+  tail.store(t + count, std::memory_order_release);
+  return count;
+}
+
+bool Telemetry::start() {
+  if (running) return true;
+  if (!Brain.SDcard.isInserted()) return false;
+
+  // Keep the logs of earlier runs: use the first unused file name.
+  for (int i = 0; i < 100; i++) {
+    snprintf(filename, sizeof(filename), "telemetry%02d.bin", i);
+    if (!Brain.SDcard.exists(filename)) break;
+  }
+  // The header holds a magic number, the format version and the record size.
+  uint8_t header[8] = {'R', 'G', 'B', 'T'};
+  uint16_t version = TELEMETRY_VERSION, size = sizeof(TelemetryRecord);
+  memcpy(header + 4, &version, 2);
+  memcpy(header + 6, &size, 2);
+  Brain.SDcard.savefile(filename, header, sizeof(header));
+
+  // Records pushed before the file existed are stale; start from an empty ring.
+  tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+  running = true;
+  task flushThread = task(flushTask, this, task::taskPriorityLow);
+  return true;
+}
+
+int Telemetry::flush() {
+  static TelemetryRecord batch[BATCH_SIZE];
+  int count = pop(batch, BATCH_SIZE);
+  if (count > 0) {
+    Brain.SDcard.appendfile(filename, (uint8_t*)batch, count * sizeof(TelemetryRecord));
+  }
+  return count;
+}
+
+int Telemetry::flushTask(void* telemetry) {
+  Telemetry* self = (Telemetry*)telemetry;
+  while (true) {
+    // Keep writing while full batches are waiting, then let the ring fill up again.
+    while (self->flush() == BATCH_SIZE) {
+      this_thread::yield();
+    }
+    wait(200, msec);
+  }
+  return 0;
+}
+
+const char* Telemetry::getFilename() {
+  return filename;
+}
+
+uint32_t Telemetry::getPending() {
+  return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+uint32_t Telemetry::getDropped() {
+  return dropped.load(std::memory_order_relaxed);
+}
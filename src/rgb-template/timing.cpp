@@ -0,0 +1,212 @@
+#include "vex.h"
+
+MotionTimer motionTimer;
+
+// Gets the short name of a TelemetrySource for the reports.
+static const char* sourceName(uint8_t source) {
+  switch (source) {
+  case TELEMETRY_TURN: return "turn";
+  case TELEMETRY_DRIVE: return "drive";
+  case TELEMETRY_PROFILED: return "profiled";
+  case TELEMETRY_PATH: return "path";
+  case TELEMETRY_SWING: return "swing";
+  case TELEMETRY_ARC: return "arc";
+  default: return "other";
+  }
+}
+
+static const char* exitName(uint8_t exit) {
+  switch (exit) {
+  case MOTION_SETTLED: return "settled";
+  case MOTION_TIMED_OUT: return "timeout";
+  case MOTION_PASSED: return "passed";
+  default: return "cancelled";
+  }
+}
+
+MotionTimer::MotionTimer() {
+  runName[0] = '\0';
+}
+
+void MotionTimer::startRun(const char* name, int firstStep) {
+  snprintf(runName, sizeof(runName), "%s", name);
+  step = firstStep;
+  motionCount = 0;
+  runStart = timer::system();
+  runTime = 0;
+}
+
+void MotionTimer::setStep(int step) {
+  this -> step = step;
+}
+
+void MotionTimer::finishRun() {
+  runTime = timer::system() - runStart;
+}
+
+void MotionTimer::saveRun(Run& run) {
+  memcpy(run.motions, motions, motionCount * sizeof(MotionTiming));
+  run.motionCount = motionCount;
+  memcpy(run.name, runName, sizeof(runName));
+  run.step = step;
+  run.start = runStart;
+  run.time = runTime;
+}
+
+void MotionTimer::restoreRun(const Run& run) {
+  memcpy(motions, run.motions, run.motionCount * sizeof(MotionTiming));
+  motionCount = run.motionCount;
+  memcpy(runName, run.name, sizeof(runName));
+  step = run.step;
+  runStart = run.start;
+  runTime = run.time;
+}
+
+void MotionTimer::beginMotion(uint8_t source, float target, float settleError) {
+  timing = motionCount < MAX_MOTIONS;
+  if (!timing) return;
+  MotionTiming& motion = motions[motionCount];
+  motion.source = source;
+  motion.exit = MOTION_SETTLED;
+  motion.step = step;
+  motion.target = target;
+  motion.totalTime = 0;
+  motion.movingTime = 0;
+  motion.bandTime = 0;
+  motion.firstBandTime = -1;
+  motion.overshoot = 0;
+  this -> settleError = settleError;
+  startSign = 0;
+  motionStart = timer::system();
+}
+
+void MotionTimer::updateMotion(float error, float dt) {
+  if (!timing) return;
+  MotionTiming& motion = motions[motionCount];
+  // The side of the target the motion starts on; going past it to the other side is overshoot.
+  if (startSign == 0 && error != 0) startSign = error > 0 ? 1 : -1;
+  if (-error * startSign > motion.overshoot) motion.overshoot = -error * startSign;
+  if (fabs(error) < settleError) {
+    if (motion.firstBandTime < 0) motion.firstBandTime = timer::system() - motionStart;
+    motion.bandTime += dt;
+  }
+}
+
+void MotionTimer::endMotion(MotionExit exit) {
+  lastExit = exit;
+  if (!timing) return;
+  timing = false;
+  MotionTiming& motion = motions[motionCount];
+  motion.exit = exit;
+  motion.totalTime = timer::system() - motionStart;
+  if (motion.bandTime > motion.totalTime) motion.bandTime = motion.totalTime;
+  motion.movingTime = motion.totalTime - motion.bandTime;
+  motionCount++;
+}
+
+int MotionTimer::getCount() {
+  return motionCount;
+}
+
+MotionTiming MotionTimer::getMotion(int index) {
+  return motions[index];
+}
+
+float MotionTimer::getRunTime() {
+  return runTime;
+}
+
+MotionExit MotionTimer::getLastExit() {
+  return lastExit;
+}
+
+void MotionTimer::report() {
+  // Add up the time of each step.
+  int steps[MAX_STEPS];
+  float stepTime[MAX_STEPS], stepBandTime[MAX_STEPS];
+  int stepTimeouts[MAX_STEPS];
+  int stepCount = 0;
+  float motionTime = 0;
+  for (int i = 0; i < motionCount; i++) {
+    motionTime += motions[i].totalTime;
+    int s = 0;
+    while (s < stepCount && steps[s] != motions[i].step) s++;
+    if (s == stepCount) {
+      if (stepCount == MAX_STEPS) continue;
+      steps[s] = motions[i].step;
+      stepTime[s] = stepBandTime[s] = 0;
+      stepTimeouts[s] = 0;
+      stepCount++;
+    }
+    stepTime[s] += motions[i].totalTime;
+    stepBandTime[s] += motions[i].bandTime;
+    if (motions[i].exit == MOTION_TIMED_OUT) stepTimeouts[s]++;
+  }
+
+  // Rank the steps and the motions by time, slowest first.
+  int stepOrder[MAX_STEPS], motionOrder[MAX_MOTIONS];
+  for (int i = 0; i < stepCount; i++) stepOrder[i] = i;
+  for (int i = 0; i < motionCount; i++) motionOrder[i] = i;
+  for (int i = 1; i < stepCount; i++) {
+    for (int j = i; j > 0 && stepTime[stepOrder[j]] > stepTime[stepOrder[j - 1]]; j--) {
+      int t = stepOrder[j]; stepOrder[j] = stepOrder[j - 1]; stepOrder[j - 1] = t;
+    }
+  }
+  for (int i = 1; i < motionCount; i++) {
+    for (int j = i; j > 0 && motions[motionOrder[j]].totalTime > motions[motionOrder[j - 1]].totalTime; j--) {
+      int t = motionOrder[j]; motionOrder[j] = motionOrder[j - 1]; motionOrder[j - 1] = t;
+    }
+  }
+
+  // The time outside the motions: waits, mechanisms and the code between the motions.
+  float otherTime = runTime > motionTime ? runTime - motionTime : 0;
+  float total = runTime > 0 ? runTime : motionTime;
+  if (total <= 0) total = 1;
+
+  printf("timing %s run %lu ms, motions %.0f ms, other %.0f ms\n", runName, (unsigned long)runTime, motionTime, otherTime);
+  for (int i = 0; i < motionCount; i++) {
+    MotionTiming& m = motions[i];
+    printf("  motion %d step %d %s %.1f: %.0f ms, moving %.0f, in band %.0f, first in band %.0f, overshoot %.2f, %s\n",
+           i + 1, m.step, sourceName(m.source), m.target, m.totalTime, m.movingTime, m.bandTime, m.firstBandTime, m.overshoot, exitName(m.exit));
+  }
+  printf("  where the time went:\n");
+  for (int i = 0; i < stepCount; i++) {
+    int s = stepOrder[i];
+    printf("  step %d %.0f ms (%.0f%%), settling %.0f ms, %d timeouts\n", steps[s], stepTime[s], 100 * stepTime[s] / total, stepBandTime[s], stepTimeouts[s]);
+  }
+  printf("  other %.0f ms (%.0f%%)\n", otherTime, 100 * otherTime / total);
+
+  display.clearBrain();
+  display.printBrain(1, "%s %.1fs, motions %.1fs, other %.1fs", runName, runTime / 1000.0, motionTime / 1000.0, otherTime / 1000.0);
+  int row = 2;
+  for (int i = 0; i < stepCount && i < 4; i++, row++) {
+    int s = stepOrder[i];
+    display.printBrain(row, "step %d  %.2fs %2.0f%%  settling %.2fs  %d timeouts",
+                       steps[s], stepTime[s] / 1000.0, 100 * stepTime[s] / total, stepBandTime[s] / 1000.0, stepTimeouts[s]);
+  }
+  row++;
+  for (int i = 0; i < motionCount && row <= 12; i++, row++) {
+    MotionTiming& m = motions[motionOrder[i]];
+    display.printBrain(row, "#%d %s %.0f  %.2fs  band %.2fs  over %.1f  %s",
+                       motionOrder[i] + 1, sourceName(m.source), m.target, m.totalTime / 1000.0, m.bandTime / 1000.0, m.overshoot, exitName(m.exit));
+  }
+}
+
+bool MotionTimer::save() {
+  if (!Brain.SDcard.isInserted()) return false;
+  // Keep the timings of earlier runs: use the first unused file name.
+  char filename[16];
+  for (int i = 0; i < 100; i++) {
+    snprintf(filename, sizeof(filename), "timing%02d.csv", i);
+    if (!Brain.SDcard.exists(filename)) break;
+  }
+
+  static char text[96 * (MAX_MOTIONS + 2)];
+  int length = snprintf(text, sizeof(text), "run,%s,%lu\nmotion,step,type,target,total,moving,band,firstband,overshoot,exit\n", runName, (unsigned long)runTime);
+  for (int i = 0; i < motionCount; i++) {
+    MotionTiming& m = motions[i];
+    length += snprintf(text + length, sizeof(text) - length, "%d,%d,%s,%.1f,%.0f,%.0f,%.0f,%.0f,%.2f,%s\n",
+                       i + 1, m.step, sourceName(m.source), m.target, m.totalTime, m.movingTime, m.bandTime, m.firstBandTime, m.overshoot, exitName(m.exit));
+  }
+  return Brain.SDcard.savefile(filename, (uint8_t*)text, length) == length;
+}
@@ -0,0 +1,47 @@
+#include "vex.h"
+
+TuningSession::TuningSession(Drive* drive) :
+  drive(drive) {}
+
+MotionTiming TuningSession::runMove(int move, bool turning, float target, float maxVoltage, bool printTrace) {
+  int timedMotions = motionTimer.getCount();
+  MotionHandle handle = turning ?
+    (maxVoltage > 0 ? drive->turnToHeadingAsync(target, maxVoltage) : drive->turnToHeadingAsync(target)) :
+    (maxVoltage > 0 ? drive->driveDistanceAsync(target, maxVoltage) : drive->driveDistanceAsync(target));
+
+  uint32_t start = timer::system();
+  while (handle.isRunning()) {
+    wait(SAMPLE_PERIOD, msec);
+    if (printTrace) {
+      printf("trace %d %lu %.2f %.2f\n", move, (unsigned long)(timer::system() - start), drive->getControlError(), drive->getControlOutput());
+    }
+  }
+
+  // The motion timer times every motion; this one is the latest, unless it was stopped before it started.
+  MotionTiming timing;
+  memset(&timing, 0, sizeof(timing));
+  timing.exit = MOTION_CANCELLED;
+  if (motionTimer.getCount() > timedMotions) timing = motionTimer.getMotion(motionTimer.getCount() - 1);
+  return timing;
+}
+
+bool TuningSession::run(bool turning, float distance, float maxVoltage, bool printTrace, MotionTiming results[2]) {
+  motionTimer.saveRun(savedRun);
+  motionTimer.startRun("tune", 0);
+  float startHeading = drive->getHeading();
+  if (turning) {
+    results[0] = runMove(1, true, normalize360(startHeading + distance), maxVoltage, printTrace);
+  } else {
+    results[0] = runMove(1, false, distance, maxVoltage, printTrace);
+  }
+  // A stop command cancels the way back too.
+  if (results[0].exit == MOTION_CANCELLED) {
+    results[1] = results[0];
+  } else if (turning) {
+    results[1] = runMove(2, true, startHeading, maxVoltage, printTrace);
+  } else {
+    results[1] = runMove(2, false, -distance, maxVoltage, printTrace);
+  }
+  motionTimer.restoreRun(savedRun);
+  return results[0].exit == MOTION_SETTLED && results[1].exit == MOTION_SETTLED;
+}
@@ -31,8 +31,11 @@ int DRIVE_MODE = 0;
 // intaker example
 motor roller = motor(PORT17, ratio6_1, true);
 
-// total number of motors, including drivetrain
-const int NUMBER_OF_MOTORS = 7;
+// all motors, including drivetrain, with a short name for each one in health alerts
+motor* monitoredMotors[] = {&leftMotor1, &leftMotor2, &leftMotor3, &rightMotor1, &rightMotor2, &rightMotor3, &roller};
+const char* monitoredMotorNames[] = {"L1", "L2", "L3", "R1", "R2", "R3", "roller"};
+// watches the motors and the inertial sensor for disconnects and overheating
+HealthMonitor health(monitoredMotors, monitoredMotorNames, sizeof(monitoredMotors) / sizeof(monitoredMotors[0]), &inertial1);
 
 // sample help functions
 void intake() {
@@ -43,36 +46,52 @@ void stopRollers() {
   roller.stop(brake);
 }
 
+// "intake on", "intake off" or "intake -1" in an auton script.
+void setIntake(float on) {
+  if (on == 0) {
+    stopRollers();
+  } else {
+    roller.spin(forward, 12 * on, volt);
+  }
+}
+
 // ------------------------------------------------------------------------
 //              Button controls
 // ------------------------------------------------------------------------
 
 //simple examples
 // This function is called when the L1 button is pressed.
-void buttonL1Action() {
+void buttonL1Pressed() {
   intake();
-  
-  // Wait until the button is released to stop the rollers.
-  while(controller1.ButtonL1.pressing()) {
-    wait (20, msec);
-  }
+}
+
+// This function is called when the L1 button is released.
+void buttonL1Released() {
   stopRollers();
 }
 
 // This function is called when the R2 button is pressed.
-void buttonR2Action()
+void buttonR2Pressed()
 {
   // brake the drivetrain until the button is released.
   chassis.stop(hold);
-  controller1.rumble(".");
-  waitUntil(!controller1.ButtonR2.pressing());
+  display.rumble(".");
+}
+
+// This function is called when the R2 button is released.
+void buttonR2Released()
+{
   chassis.checkStatus();
   chassis.stop(coast);
 }
 
 void setupButtonMapping() {
-  controller1.ButtonL1.pressed(buttonL1Action);
-  controller1.ButtonR2.pressed(buttonR2Action);
+  input.on(BUTTON_L1, INPUT_PRESS, buttonL1Pressed);
+  input.on(BUTTON_L1, INPUT_RELEASE, buttonL1Released);
+  input.on(BUTTON_R2, INPUT_PRESS, buttonR2Pressed);
+  input.on(BUTTON_R2, INPUT_RELEASE, buttonR2Released);
+  // Starts sampling the controller; register all handlers before this.
+  input.start();
 }
 
 
@@ -94,30 +113,158 @@ Drive chassis(
   0.75
 );
 
-// Resets the chassis constants.
-void setChassisDefaults() {
-  // Sets the heading of the chassis to the current heading of the inertial sensor.
-  chassis.setHeading(chassis.inertialSensor.heading());
+// Records the driver and plays the recordings back as autons.
+DriverRecorder recorder(&chassis);
+// The auton scripts on the SD card.
+AutonScripts scripts(&chassis);
+
+// Adds the commands of this robot's subsystems to the auton scripts.
+void registerScriptActions() {
+  scripts.addAction("intake", setIntake);
+}
+
+// Sets the default tuning of the chassis. The tuning saved on the SD card replaces it at boot,
+// and each value can be changed over serial while the program runs, e.g. "set drive_kp 1.6".
+void setConfigDefaults() {
+  RobotConfig config;
+
+  // Sets the maximum turn, drive and heading voltage.
+  config.turnMaxVoltage = 10;
+  config.driveMaxVoltage = 10;
+  config.headingMaxVoltage = 6;
 
-  // Sets the maximum drive and turn voltage 
-  chassis.setMaxVoltage(10, 10, 6);
-  
   // Sets the drive PID constants for the chassis.
-  chassis.setDrivePID(1.5, 0, 10, 0);
+  config.driveKp = 1.5;
+  config.driveKi = 0;
+  config.driveKd = 10;
+  config.driveStarti = 0;
   // Sets the turn PID constants for the chassis.
-  chassis.setTurnPID(0.2, .015, 1.5, 7.5);
+  config.turnKp = 0.2;
+  config.turnKi = .015;
+  config.turnKd = 1.5;
+  config.turnStarti = 7.5;
   // Sets the heading PID constants for the chassis.
-  chassis.setHeadingPID(0.4, 1);
-  // Sets the exit conditions for the drive functions.
-  // These conditions are used to determine when the drive function should exit.
-  chassis.setDriveExitConditions(1, 300, 3000);
-  // Sets the exit conditions for the turn functions.
-  // These conditions are used to determine when the turn function should exit.
-  chassis.setTurnExitConditions(1.5, 300, 2000);
+  config.headingKp = 0.4;
+  config.headingKd = 1;
+  // Sets the velocity (inches/s), acceleration (inches/s^2) and jerk (inches/s^3) limits for driveDistanceProfiled.
+  // Use 0 for the jerk to get a trapezoidal profile.
+  config.maxVelocity = 40;
+  config.maxAcceleration = 80;
+  config.maxJerk = 400;
+  // Sets the feedforward constants for driveDistanceProfiled:
+  // volts per inch/s, volts per inch/s^2, and the volts needed to start moving.
+  config.kV = 0.18;
+  config.kA = 0.02;
+  config.kS = 0.5;
+  // Sets the exit conditions for the drive functions: the error in inches, and the time in
+  // milliseconds it must stay within it, before the drive function exits, and its timeout.
+  config.driveSettleError = 1;
+  config.driveSettleTime = 300;
+  config.driveTimeout = 3000;
+  // Sets the exit conditions for the turn functions, in degrees and milliseconds.
+  config.turnSettleError = 1.5;
+  config.turnSettleTime = 300;
+  config.turnTimeout = 2000;
+  // Sets how close chained motions, between startChain() and endChain(), get to their
+  // targets before handing over to the next motion: in inches and in degrees.
+  config.chainDriveError = 3;
+  config.chainTurnError = 5;
 
   // Sets the arcade drive constants for the chassis.
   // These constants are used to control the arcade drive of the chassis.
-  chassis.setArcadeConstants(0.5, 0.5, 0.85);
+  config.kBrake = 0.5;
+  config.kTurnBias = 0.5;
+  config.kTurnDampingFactor = 0.85;
+
+  // The drive mode and the auton to start with, until they are changed and saved.
+  config.driveMode = DRIVE_MODE;
+  config.autonSelection = 0;
+  // Use the gain schedules of setChassisDefaults, if it sets any.
+  config.gainScheduling = 1;
+
+  configStore.setDefaults(config);
+}
+
+// Sets the chassis up from the tuning in the config store.
+// It runs again whenever a value changes, so the change takes effect right away.
+void applyConfig() {
+  RobotConfig config = configStore.get();
+  chassis.setMaxVoltage(config.turnMaxVoltage, config.driveMaxVoltage, config.headingMaxVoltage);
+  chassis.setDrivePID(config.driveKp, config.driveKi, config.driveKd, config.driveStarti);
+  chassis.setTurnPID(config.turnKp, config.turnKi, config.turnKd, config.turnStarti);
+  chassis.setHeadingPID(config.headingKp, config.headingKd);
+  chassis.setDriveProfile(config.maxVelocity, config.maxAcceleration, config.maxJerk);
+  chassis.setDriveFeedforward(config.kV, config.kA, config.kS);
+  chassis.setDriveExitConditions(config.driveSettleError, config.driveSettleTime, config.driveTimeout);
+  chassis.setTurnExitConditions(config.turnSettleError, config.turnSettleTime, config.turnTimeout);
+  chassis.setChainExitConditions(config.chainDriveError, config.chainTurnError);
+  chassis.setArcadeConstants(config.kBrake, config.kTurnBias, config.kTurnDampingFactor);
+  chassis.setGainScheduling(config.gainScheduling != 0);
+
+  // Sets the joystick response curves for the drive mode.
+  if (config.driveMode != DRIVE_MODE) {
+    DRIVE_MODE = config.driveMode;
+    loadDriverCurves();
+  }
+}
+
+// Resets the chassis constants.
+void setChassisDefaults() {
+  // Sets the distance between the left and right wheels in inches, for driveArc and the heading fusion.
+  chassis.setTrackWidth(12);
+  // Sets how fast the fused heading follows the inertial sensor, in seconds, and how far in degrees
+  // the encoder and inertial headings may disagree before the wheels count as slipping.
+  chassis.setHeadingFusion(0.2, 3);
+
+  // Sets the period of the auton control loops in milliseconds.
+  // The PID constants keep the same behavior at any period.
+  chassis.setLoopPeriod(10);
+
+  // Sets the driver control output limits: the slew rate in volts per second, so going from full
+  // forward to full reverse takes at least 0.4 seconds, and the current budget in amps that the
+  // drive motors share with the roller, to keep current spikes from browning out the brain.
+  chassis.setOutputLimits(60, 15);
+  chassis.addCurrentLoad(roller);
+  // Slows the drive down as its motors heat up, from full voltage at 45C to half at 55C,
+  // where V5 motors start to limit their own current.
+  chassis.setThermalDerate(45, 55, 0.5);
+
+  // Sets gain schedules: PID constants and settle errors by the size of the motion, in inches for
+  // drives and degrees for turns, interpolated between the sizes given. Without them every motion
+  // uses the PID constants below. tools/fill_gains.py measures the points on the robot.
+  // GainSchedule driveSchedule, turnSchedule;
+  // driveSchedule.addPoint(6, 2.0, 0, 12, 0, 0.5);
+  // driveSchedule.addPoint(48, 1.5, 0, 10, 0, 1);
+  // turnSchedule.addPoint(15, 0.35, 0.015, 2.5, 7.5, 1);
+  // turnSchedule.addPoint(90, 0.2, 0.015, 1.5, 7.5, 1.5);
+  // chassis.setDriveSchedule(driveSchedule);
+  // chassis.setTurnSchedule(turnSchedule);
+
+  // Sets the joystick response curves for the current drive mode.
+  loadDriverCurves();
+
+  // Sets the PID constants, exit conditions and the other tuning: the defaults above, replaced
+  // by the tuning saved on the SD card if there is one.
+  setConfigDefaults();
+  configStore.setApply(applyConfig);
+  configStore.load();
+}
+
+// Sets the joystick response curves for each drive mode, so each driver can have their own feel.
+// Each curve is turned into a lookup table here, once, instead of being computed on every driver control tick.
+void loadDriverCurves() {
+  switch (DRIVE_MODE) {
+  default:
+    // Exponential curves: finer control near the center of the stick, more for turning than driving.
+    chassis.setDriverCurves(ResponseCurve::exponential(5), ResponseCurve::exponential(10));
+    break;
+  // Example of a hand-shaped throttle curve and a cubic turn curve for the tank drive driver:
+  // case 2: {
+  //   const float stick[] = {0, 20, 70, 100}, power[] = {0, 10, 50, 100};
+  //   chassis.setDriverCurves(ResponseCurve::piecewise(stick, power, 4), ResponseCurve::cubic(0.6));
+  //   break;
+  // }
+  }
 }
 
 
@@ -126,8 +273,10 @@ void setChassisDefaults() {
 // ------------------------------------------------------------------------
 
 void changeDriveMode(){
-  controller1.rumble("-");
-  DRIVE_MODE = (DRIVE_MODE +1)%3;
+  display.rumble("-");
+  // Remembers the drive mode across restarts.
+  configStore.set("drive_mode", (DRIVE_MODE + 1) % 3);
+  configStore.save();
     switch (DRIVE_MODE) {
     case 0:
       printControllerScreen("Double Arcade");
@@ -152,6 +301,11 @@ void usercontrol(void) {
 
   // This loop runs forever, controlling the robot during the driver control period.
   while (1) {
+    // A recording played back from test mode drives the robot by itself.
+    if (recorder.isPlaying()) {
+      wait(20, msec);
+      continue;
+    }
     switch (DRIVE_MODE) {
     case 0: // double arcade
       chassis.controlArcade(controller1.Axis2.position(), controller1.Axis4.position());
@@ -165,6 +319,9 @@ void usercontrol(void) {
       chassis.controlMecanum(controller1.Axis4.position(), controller1.Axis3.position(), controller1.Axis2.position(), controller1.Axis1.position(), leftMotor1, leftMotor2, rightMotor1, rightMotor2);
       break;
     }
+    chassis.recordDriverTelemetry();
+    // Records this tick if the driver is recording an auton.
+    recorder.recordTick();
 
     // This wait prevents the loop from using too much CPU time.
     wait(20, msec);
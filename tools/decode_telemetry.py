@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Converts telemetryNN.bin files from the robot's SD card to CSV.
+
+Usage: decode_telemetry.py telemetry00.bin [more.bin ...]
+Writes telemetry00.csv next to each input file.
+
+The record layout matches TelemetryRecord in include/rgb-template/telemetry.h. Each version only
+added fields at the end, so older files decode to the columns they have.
+"""
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHH")
+# The record of each TELEMETRY_VERSION.
+RECORDS = {
+    1: struct.Struct("<IBBBB10f"),
+    # Added requested_v and limits.
+    2: struct.Struct("<IBBBB11fB3x"),
+    # Added inertial_heading.
+    3: struct.Struct("<IBBBB11fB3xf"),
+}
+LATEST = max(RECORDS)
+SOURCES = {1: "turn", 2: "drive", 3: "profiled", 4: "path", 5: "driver", 6: "swing", 7: "arc"}
+LIMITS = [(1, "slew"), (2, "current"), (4, "thermal")]
+COLUMNS = ["time_ms", "source", "motion", "left_temp_c", "right_temp_c",
+           "error", "p", "i", "d", "output_v", "heading",
+           "left_position_in", "right_position_in", "left_current_a", "right_current_a",
+           "requested_v", "limits", "inertial_heading"]
+
+
+def decode(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, size = HEADER.unpack_from(data, 0)
+    if magic != b"RGBT":
+        raise ValueError("%s is not a telemetry file" % path)
+    # A newer version than this decoder knows still starts with the fields of the latest one.
+    record = RECORDS.get(min(version, LATEST))
+    if record is None or size < record.size or (version <= LATEST and size != record.size):
+        raise ValueError("%s has version %d with %d byte records, which this decoder does not know"
+                         % (path, version, size))
+    if version > LATEST:
+        print("%s: version %d is newer than this decoder, decoding the version %d fields"
+              % (path, version, LATEST))
+
+    out_path = path.rsplit(".", 1)[0] + ".csv"
+    count = (len(data) - HEADER.size) // size
+    with open(out_path, "w") as out:
+        columns = len(record.unpack(bytes(record.size)))
+        out.write(",".join(COLUMNS[:columns]) + "\n")
+        for n in range(count):
+            fields = list(record.unpack_from(data, HEADER.size + n * size))
+            fields[1] = SOURCES.get(fields[1], str(fields[1]))
+            if len(fields) > 16:
+                fields[16] = "+".join(name for bit, name in LIMITS if fields[16] & bit)
+            out.write(",".join(f if isinstance(f, str) else
+                               ("%.4g" % f if isinstance(f, float) else str(f)) for f in fields) + "\n")
+    print("%s: %d records -> %s" % (path, count, out_path))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    for arg in sys.argv[1:]:
+        decode(arg)
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""Fills a gain schedule by measuring test moves of several sizes on the robot over serial.
+
+Usage: fill_gains.py PORT turn|drive [--sizes S ...] [--kp-factors F ...] [--kd-factors F ...]
+                     [--max-overshoot X] [--voltage V] [--csv FILE]
+
+For each size, tries the test move there and back ("tune turn 90" or "tune drive 24", see
+include/rgb-template/command.h) with the current constants scaled: first kp and kd together by each
+--kp-factors, then kd alone by each --kd-factors around the best of those. The fastest try that
+settles both ways within --max-overshoot becomes the point of that size. ki, starti and the settle
+error stay as they are. The gain schedules are off while measuring, and the constants and the gain
+scheduling are put back at the end, so nothing changes on the robot.
+
+Prints the schedule as C++ to paste into setChassisDefaults() in src/robot-config.cpp. --csv writes
+every try to a file. The robot needs room for the largest drive, there and back.
+
+Needs pyserial (pip install pyserial), and tune.py next to this file.
+"""
+import argparse
+import sys
+
+import serial
+
+from tune import command
+
+DEFAULT_SIZES = {"turn": [10, 30, 60, 90, 135, 170], "drive": [3, 6, 12, 24, 48, 96]}
+DEFAULT_OVERSHOOT = {"turn": 2.0, "drive": 1.0}
+CONSTANTS = ["kp", "ki", "kd", "starti", "settle_error"]
+
+
+def get(port, name):
+    """Gets a config parameter; the reply is "ok name value"."""
+    return float(command(port, "get " + name)[-1].split()[2])
+
+
+def try_gains(port, move, size, kp, kd, voltage):
+    """Runs the test move with kp and kd. Returns the mean time of the two moves, the largest
+    overshoot, and whether both settled."""
+    command(port, "set %s_kp %g" % (move, kp))
+    command(port, "set %s_kd %g" % (move, kd))
+    line = "tune %s %g" % (move, size)
+    if voltage > 0:
+        line += " %g" % voltage
+    times, overshoots, settled = [], [], True
+    for reply in command(port, line):
+        if reply.startswith("result"):
+            # result move time ms firstband ms overshoot value exit
+            fields = reply.split()
+            times.append(float(fields[3]))
+            overshoots.append(float(fields[7]))
+            settled = settled and fields[8] == "settled"
+    if len(times) < 2:
+        return 0, 0, False
+    return sum(times) / len(times), max(overshoots), settled
+
+
+def fill(port, args, constants, log):
+    """Measures each size and returns the points of the schedule as (size, kp, ki, kd, starti, settle error)."""
+    points = []
+    for size in args.sizes:
+        best = None
+
+        def measure(kp, kd):
+            nonlocal best
+            time, overshoot, settled = try_gains(port, args.move, size, kp, kd, args.voltage)
+            passed = settled and overshoot <= args.max_overshoot
+            log.append((size, kp, kd, time, overshoot, settled, passed))
+            print("  %s %g: kp %.4g kd %.4g -> %.0f ms, overshoot %.2f%s"
+                  % (args.move, size, kp, kd, time, overshoot, "" if passed else ", rejected"), file=sys.stderr)
+            if passed and (best is None or time < best[0]):
+                best = (time, kp, kd)
+
+        for factor in args.kp_factors:
+            measure(constants["kp"] * factor, constants["kd"] * factor)
+        if best is not None:
+            kp, kd = best[1], best[2]
+            for factor in args.kd_factors:
+                if factor != 1:
+                    measure(kp, kd * factor)
+
+        if best is None:
+            print("  %s %g: nothing passed, leaving the size out" % (args.move, size), file=sys.stderr)
+            continue
+        points.append((size, best[1], constants["ki"], best[2], constants["starti"], constants["settle_error"]))
+    return points
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fills a gain schedule from test moves on the robot.")
+    parser.add_argument("port")
+    parser.add_argument("move", choices=["turn", "drive"])
+    parser.add_argument("--sizes", type=float, nargs="+", help="degrees to turn or inches to drive")
+    parser.add_argument("--kp-factors", type=float, nargs="+", default=[0.6, 0.8, 1, 1.25, 1.6])
+    parser.add_argument("--kd-factors", type=float, nargs="+", default=[0.7, 1.4])
+    parser.add_argument("--max-overshoot", type=float, help="in degrees or inches")
+    parser.add_argument("--voltage", type=float, default=0, help="max voltage, the chassis maximum by default")
+    parser.add_argument("--csv", help="write every try to this CSV file")
+    args = parser.parse_args()
+    if args.sizes is None:
+        args.sizes = DEFAULT_SIZES[args.move]
+    if args.max_overshoot is None:
+        args.max_overshoot = DEFAULT_OVERSHOOT[args.move]
+
+    log = []
+    # A tune takes a few seconds, but no reply should take longer than the motion timeouts.
+    with serial.Serial(args.port, 115200, timeout=10) as port:
+        constants = dict((name, get(port, "%s_%s" % (args.move, name))) for name in CONSTANTS)
+        scheduling = get(port, "gain_scheduling")
+        command(port, "set gain_scheduling 0")
+        try:
+            points = fill(port, args, constants, log)
+        finally:
+            command(port, "set %s_kp %g" % (args.move, constants["kp"]))
+            command(port, "set %s_kd %g" % (args.move, constants["kd"]))
+            command(port, "set gain_scheduling %d" % scheduling)
+
+    if args.csv:
+        with open(args.csv, "w") as out:
+            out.write("size,kp,kd,time_ms,overshoot,settled,passed\n")
+            for row in log:
+                out.write("%g,%g,%g,%.0f,%.3f,%d,%d\n" % row)
+
+    name = args.move + "Schedule"
+    print("GainSchedule %s;" % name)
+    for point in points:
+        print("%s.addPoint(%g, %.4g, %.4g, %.4g, %g, %g);" % ((name,) + point))
+    print("chassis.set%sSchedule(%s);" % (args.move.capitalize(), name))
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except (RuntimeError, TimeoutError) as error:
+        sys.exit(str(error))
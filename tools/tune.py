@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Runs one try of a PID tuning session on the robot over the USB serial port.
+
+Usage: tune.py PORT turn|drive DISTANCE [--kp K] [--ki K] [--kd K] [--starti S]
+               [--settle-error E] [--settle-time MS] [--timeout MS]
+               [--voltage V] [--save] [--trace FILE.csv]
+
+Sets the constants that are given, for the turn or the drive PID, runs the test move there and
+back ("tune turn 90" or "tune drive 24", see include/rgb-template/command.h) and prints the time,
+time to the settle band and overshoot of each move. The constants take effect right away and stay
+until the program restarts; --save keeps them on the SD card. --trace writes the error and output
+of every sample to a CSV file. With gain schedules, the schedule replaces the constants; send
+"set gain_scheduling 0" first to tune them.
+
+Needs pyserial (pip install pyserial). PORT is the user port of the brain or controller, e.g.
+/dev/ttyACM1 or COM4.
+"""
+import argparse
+import sys
+
+import serial
+
+PARAMETERS = ["kp", "ki", "kd", "starti", "settle_error", "settle_time", "timeout"]
+# The start byte of the binary frames the telemetry stream sends on the same port.
+FRAME_START = 0xA5
+
+
+def read_line(port):
+    """Reads a text line, skipping the telemetry frames around it. Returns "" on a timeout."""
+    line = bytearray()
+    while True:
+        byte = port.read(1)
+        if not byte:
+            return ""
+        if byte[0] == FRAME_START:
+            # Type, sequence and payload length, then the payload and the checksum.
+            header = port.read(3)
+            if len(header) == 3:
+                port.read(header[2] + 1)
+        elif byte == b"\n":
+            return line.decode(errors="replace").strip() or read_line(port)
+        elif byte != b"\r":
+            line += byte
+
+
+def command(port, line, trace=None):
+    """Sends a line and returns the reply lines up to the one that ends the command."""
+    port.write((line + "\n").encode())
+    replies = []
+    while True:
+        reply = read_line(port)
+        if not reply:
+            raise TimeoutError("no reply to %r" % line)
+        if reply.startswith("trace"):
+            if trace is not None:
+                trace.append(reply.split()[1:])
+            continue
+        replies.append(reply)
+        if reply.startswith("error"):
+            raise RuntimeError(reply)
+        # A tune is acknowledged with "ok" and ends with "done"; the other commands end with "ok".
+        if reply.startswith("done") or (reply.startswith("ok") and not line.startswith("tune")):
+            return replies
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs one try of a PID tuning session over serial.")
+    parser.add_argument("port")
+    parser.add_argument("move", choices=["turn", "drive"])
+    parser.add_argument("distance", type=float, help="degrees to turn or inches to drive")
+    for name in PARAMETERS:
+        parser.add_argument("--" + name.replace("_", "-"), type=float)
+    parser.add_argument("--voltage", type=float, default=0, help="max voltage, the chassis maximum by default")
+    parser.add_argument("--save", action="store_true", help="keep the constants on the SD card")
+    parser.add_argument("--trace", help="write the error trace to this CSV file")
+    args = parser.parse_args()
+
+    # A tune takes a few seconds, but no reply should take longer than the motion timeouts.
+    with serial.Serial(args.port, 115200, timeout=10) as port:
+        for name in PARAMETERS:
+            value = getattr(args, name)
+            if value is not None:
+                command(port, "set %s_%s %g" % (args.move, name, value))
+
+        trace = []
+        line = "tune %s %g" % (args.move, args.distance)
+        if args.voltage > 0:
+            line += " %g" % args.voltage
+        for reply in command(port, line, trace):
+            if reply.startswith("result"):
+                # result move time ms firstband ms overshoot value exit
+                fields = reply.split()
+                print("move %s: %s ms, in band after %s ms, overshoot %s, %s"
+                      % (fields[1], fields[3], fields[5], fields[7], fields[8]))
+
+        if args.save:
+            command(port, "save")
+        if args.trace:
+            with open(args.trace, "w") as out:
+                out.write("move,time_ms,error,output_v\n")
+                for fields in trace:
+                    out.write(",".join(fields) + "\n")
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except (RuntimeError, TimeoutError) as error:
+        sys.exit(str(error))